@@ -33,6 +33,8 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 18/01/2024 | Document creation		                         |
+ * | 16/10/2026 | SPI initialized once, queued pixel transfers	 |
+ * | 16/10/2026 | Bus acquired for each command + data sequence	 |
  *
  */
 
@@ -31,6 +31,7 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 17/05/2024 | Document creation		                         |
+ * | 17/10/2026 | Fixed backward direction, atomic pin update	 |
  *
  */
 
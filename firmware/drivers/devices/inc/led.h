@@ -18,6 +18,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 17/10/2026 | LEDs updated together with GPIOWriteMask()							|
  * 
  **/
 
@@ -17,6 +17,8 @@
  * |   Date	| Description                                    			|
  * |:----------:|:----------------------------------------------------------------------|
  * | 30/01/2024 | Document creation		                         		|
+ * | 16/10/2026 | Register reads in a single I2C transaction			|
+ * | 16/10/2026 | Configuration registers cached in RAM					|
  * 
  **/
 
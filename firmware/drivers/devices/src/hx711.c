@@ -14,6 +14,7 @@
 #include <delay_mcu.h>
 
 /*==================[macros and definitions]=================================*/
+#define SCK_PULSE_NS	500		/*!< PD_SCK high/low time (min 0.2us, PD_SCK high > 60us powers down the chip) */
 
 /*==================[internal data declaration]==============================*/
 uint8_t GAIN;		             /*!<  Amplification factor */
@@ -50,6 +51,7 @@ void HX711_Init(uint8_t gain, gpio_t pd_sck, gpio_t dout)
 	internal_dout = dout;
 	GPIOInit(pd_sck, GPIO_OUTPUT);//PD_SCK_SET_OUTPUT;
 	GPIOInit(dout, GPIO_INPUT);//DOUT_SET_INPUT;
+    DelayCyclesCalibrate();
     HX711_setGain(gain);
 
 }
@@ -88,28 +90,28 @@ uint32_t HX711_read(void)
 
     GPIOOn(internal_dout);//DOUT_SET_HIGH;
 
-    DelayUs(1);
+    DelayNs(SCK_PULSE_NS);
 
     GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
-    DelayUs(1);
+    DelayNs(SCK_PULSE_NS);
 
     count=0;
     while(GPIORead(internal_dout));
     for(i=0;i<24;i++)
     {
     	 GPIOOn(internal_pd_sck);//PD_SCK_SET_HIGH;
-    	 DelayUs(1);
+    	 DelayNs(SCK_PULSE_NS);
         count=count<<1;
         GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
-        DelayUs(1);
+        DelayNs(SCK_PULSE_NS);
         if(GPIORead(internal_dout))
             count++;
     }
     count = count>>6;
     GPIOOn(internal_pd_sck);//PD_SCK_SET_HIGH;
-    DelayUs(1);
+    DelayNs(SCK_PULSE_NS);
     GPIOOff(internal_pd_sck);//PD_SCK_SET_LOW;
-    DelayUs(1);
+    DelayNs(SCK_PULSE_NS);
     count ^= 0x800000;
     return(count);
 }
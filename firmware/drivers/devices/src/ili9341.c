@@ -194,7 +194,10 @@ static orientation_properties_t lcd_orientation = {
 /*==================[internal functions definition]==========================*/
 
 void WriteLCD(lcd_cmd_t * data){
-	SpiInit(&spi_conf);
+	/* DC must not change while queued pixel data is being sent */
+	SpiWaitAll(ili9341_spi);
+	/* Command and data are sent without other devices transactions in between */
+	SpiAcquireBus(ili9341_spi, SPI_WAIT_FOREVER);
 	/* If command is NULL don't send command */
 	if (data->cmd != NULL){
 		/* Send command */
@@ -207,6 +210,19 @@ void WriteLCD(lcd_cmd_t * data){
 		GPIOOn(ili9341_dc);
 		SpiWrite(ili9341_spi, data->data, data->databytes);
 	}
+	SpiReleaseBus(ili9341_spi);
+}
+
+/**
+ * @brief  		Queue pixel data to LCD without waiting for the transfer
+ * @note		Buffer must not be modified until the transfer ends (see SpiWaitTransfer())
+ * @param[in]  	data: Pixel data
+ * @param[in]  	databytes: Number of bytes
+ * @retval 		None
+ */
+static void WriteLCDAsync(const uint8_t * data, uint16_t databytes){
+	GPIOOn(ili9341_dc);
+	SpiQueueTransfer(ili9341_spi, data, NULL, databytes);
 }
 
 void SetCursorPosition(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1){
@@ -258,13 +274,12 @@ void Fill(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color){
 	lcd_cmd_t lcd_write = {MEM_WRITE, NULL, NULL};
 	WriteLCD(&lcd_write);
 
+	/* Every block sends the same buffer, so all of them can be queued */
 	while(bytes_count - MAX_VALUE_SIZE > 0){
-		lcd_cmd_t lcd_pixel = {NULL, MAX_VALUE_SIZE, pixel};
-		WriteLCD(&lcd_pixel);
+		WriteLCDAsync(pixel, MAX_VALUE_SIZE);
 		bytes_count -= MAX_VALUE_SIZE;
 	}
-	lcd_cmd_t lcd_pixel = {NULL, bytes_count, pixel};
-	WriteLCD(&lcd_pixel);
+	WriteLCDAsync(pixel, bytes_count);
 }
 
 /*==================[external functions definition]==========================*/
@@ -273,6 +288,7 @@ uint8_t ILI9341Init(spi_dev_t spi_dev, uint8_t gpio_dc, uint8_t gpio_rst){
 	/* SPI configuration */
 	spi_conf.device = spi_dev;
 	ili9341_spi = spi_dev;
+	SpiInit(&spi_conf);
 	/* GPIOs configuration and initialization */
 	ili9341_dc = gpio_dc;
 	ili9341_rst = gpio_rst;
@@ -802,7 +818,8 @@ void ILI9341DrawFilledTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, i
 void ILI9341DrawPicture(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* pic){
 	static uint16_t i, j;
 	static int32_t bytes_count;
-	static uint8_t pixel[MAX_VALUE_SIZE];
+	static uint8_t pixel_buffers[2][MAX_VALUE_SIZE];
+	uint8_t *pixel;
 
 	SetCursorPosition(x, y, x + width - 1, y + height - 1);
 
@@ -813,21 +830,28 @@ void ILI9341DrawPicture(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
 	lcd_cmd_t lcd_write = {MEM_WRITE, NULL, NULL};
 	WriteLCD(&lcd_write);
 
+	/* Double buffer: one block is copied while the previous one is sent */
 	j = 0;
 	while(bytes_count - MAX_VALUE_SIZE > 0){
+		pixel = pixel_buffers[j % 2];
+		if (SpiPending(ili9341_spi) > 1){
+			SpiWaitTransfer(ili9341_spi, SPI_WAIT_FOREVER);
+		}
 		for (i = 0; i < MAX_VALUE_SIZE; i++){
 			pixel[i] = pic[j * MAX_VALUE_SIZE + i];
 		}
-		lcd_cmd_t lcd_pixel = {NULL, MAX_VALUE_SIZE, pixel};
-		WriteLCD(&lcd_pixel);
+		WriteLCDAsync(pixel, MAX_VALUE_SIZE);
 		bytes_count -= MAX_VALUE_SIZE;
 		j++;
 	}
+	pixel = pixel_buffers[j % 2];
+	if (SpiPending(ili9341_spi) > 1){
+		SpiWaitTransfer(ili9341_spi, SPI_WAIT_FOREVER);
+	}
 	for (i = 0; i < bytes_count; i++){
 		pixel[i] = pic[j * MAX_VALUE_SIZE + i];
 	}
-	lcd_cmd_t lcd_pixel = {NULL, bytes_count, pixel};
-	WriteLCD(&lcd_pixel);
+	WriteLCDAsync(pixel, bytes_count);
 }
 
 uint8_t ILI9341DeInit(void){
@@ -24,6 +24,8 @@
 #define EN_3_4			GPIO_19
 #define A_3				GPIO_18
 #define A_4				GPIO_9
+#define A_1_2_MASK		(GPIO_MASK(A_1) | GPIO_MASK(A_2))
+#define A_3_4_MASK		(GPIO_MASK(A_3) | GPIO_MASK(A_4))
 /*==================[typedef]================================================*/
 
 /*==================[internal data declaration]==============================*/
@@ -55,39 +57,33 @@ uint8_t L293SetSpeed(l293_motor_t motor, int8_t speed){
 	case MOTOR_1:
 		if(speed == 0){
 			PWMSetDutyCycle(PWM_0, speed);
-			GPIOOff(A_1);
-			GPIOOff(A_2);
+			GPIOWriteMask(A_1_2_MASK, 0);
 		}
 		if(speed > 0){
 			if (speed > MAX_F_SPEED) speed = MAX_F_SPEED;
 			PWMSetDutyCycle(PWM_0, speed);
-			GPIOOn(A_1);
-			GPIOOff(A_2);
+			GPIOWriteMask(A_1_2_MASK, GPIO_MASK(A_1));
 		}
 		if(speed < 0){
 			if (speed < MAX_B_SPEED) speed = MAX_B_SPEED;
 			PWMSetDutyCycle(PWM_0, -speed);
-			GPIOOn(A_1);
-			GPIOOff(A_2);
+			GPIOWriteMask(A_1_2_MASK, GPIO_MASK(A_2));
 		}
 		break;
 	case MOTOR_2:
 		if(speed == 0){
 			PWMSetDutyCycle(PWM_1, speed);
-			GPIOOff(A_3);
-			GPIOOff(A_4);
+			GPIOWriteMask(A_3_4_MASK, 0);
 		}
 		if(speed > 0){
 			if (speed > MAX_F_SPEED) speed = MAX_F_SPEED;
 			PWMSetDutyCycle(PWM_1, speed);
-			GPIOOn(A_3);
-			GPIOOff(A_4);
+			GPIOWriteMask(A_3_4_MASK, GPIO_MASK(A_3));
 		}
 		if(speed < 0){
 			if (speed < MAX_B_SPEED) speed = MAX_B_SPEED;
 			PWMSetDutyCycle(PWM_1, -speed);
-			GPIOOn(A_3);
-			GPIOOff(A_4);
+			GPIOWriteMask(A_3_4_MASK, GPIO_MASK(A_4));
 		}
 		break;
 	default:
@@ -14,7 +14,6 @@
 #include "math.h"
 #include <string.h>
 /*==================[macros and definitions]=================================*/
-#define I2C_NUM I2C_NUM_0
 
 /*==================[internal data definition]===============================*/
 uint8_t devAddr;
@@ -24,21 +23,7 @@ uint8_t buffer[14];
 /*==================[external functions definition]==========================*/
 void MPU6050_ReadRegister(uint8_t reg, uint8_t *data, uint8_t len){
 	uint8_t dev = 0x68;
-	i2c_cmd_handle_t cmd;
-	I2C_SelectRegister(dev, reg);
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (dev << 1) | I2C_MASTER_READ, 1));
-
-	if(len>1)
-		ESP_ERROR_CHECK(i2c_master_read(cmd, data, len, I2C_MASTER_ACK));
-
-	ESP_ERROR_CHECK(i2c_master_read_byte(cmd, data+len-1, I2C_MASTER_NACK));
-
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_NUM, cmd, 1000));
-	i2c_cmd_link_delete(cmd);
+	I2C_readBytes(dev, reg, len, data, I2C_MASTER_TIMEOUT_MS);
 }
 
 void MPU6050_Address(uint8_t address) {
@@ -47,6 +32,13 @@ void MPU6050_Address(uint8_t address) {
 
 void MPU6050_initialize() {
 	devAddr = MPU6050_DEFAULT_ADDRESS;
+	/* Configuration registers are kept in RAM, status/data/FIFO/DMP memory registers are always read */
+	I2C_cacheEnable(devAddr);
+	I2C_cacheSetVolatile(devAddr, MPU6050_RA_I2C_SLV4_DI, MPU6050_RA_I2C_MST_STATUS - MPU6050_RA_I2C_SLV4_DI + 1);
+	I2C_cacheSetVolatile(devAddr, MPU6050_RA_INT_STATUS, MPU6050_RA_MOT_DETECT_STATUS - MPU6050_RA_INT_STATUS + 1);
+	I2C_cacheSetVolatile(devAddr, MPU6050_RA_SIGNAL_PATH_RESET, 1);
+	I2C_cacheSetVolatile(devAddr, MPU6050_RA_BANK_SEL, MPU6050_RA_MEM_R_W - MPU6050_RA_BANK_SEL + 1);
+	I2C_cacheSetVolatile(devAddr, MPU6050_RA_FIFO_COUNTH, MPU6050_RA_FIFO_R_W - MPU6050_RA_FIFO_COUNTH + 1);
     MPU6050_setClockSource(MPU6050_CLOCK_PLL_XGYRO);
     MPU6050_setFullScaleGyroRange(MPU6050_GYRO_FS_250);
     MPU6050_setFullScaleAccelRange(MPU6050_ACCEL_FS_2);
@@ -2374,6 +2366,8 @@ void MPU6050_switchSPIEnabled(bool enabled) {
  */
 void MPU6050_resetFIFO() {
     I2C_writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_RESET_BIT, true);
+    /* reset bit is cleared by the device */
+    I2C_cacheInvalidate(devAddr, MPU6050_RA_USER_CTRL, 1);
 }
 /** Reset the I2C Master.
  * This bit resets the I2C Master when set to 1 while I2C_MST_EN equals 0.
@@ -2383,6 +2377,8 @@ void MPU6050_resetFIFO() {
  */
 void MPU6050_resetI2CMaster() {
     I2C_writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_I2C_MST_RESET_BIT, true);
+    /* reset bit is cleared by the device */
+    I2C_cacheInvalidate(devAddr, MPU6050_RA_USER_CTRL, 1);
 }
 /** Reset all sensor registers and signal paths.
  * When set to 1, this bit resets the signal paths for all sensors (gyroscopes,
@@ -2398,6 +2394,8 @@ void MPU6050_resetI2CMaster() {
  */
 void MPU6050_resetSensors() {
     I2C_writeBit(devAddr, MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_SIG_COND_RESET_BIT, true);
+    /* reset bit is cleared by the device */
+    I2C_cacheInvalidate(devAddr, MPU6050_RA_USER_CTRL, 1);
 }
 
 // PWR_MGMT_1 register
@@ -2409,6 +2407,8 @@ void MPU6050_resetSensors() {
  */
 void MPU6050_reset() {
     I2C_writeBit(devAddr, MPU6050_RA_PWR_MGMT_1, MPU6050_PWR1_DEVICE_RESET_BIT, true);
+    /* every register goes back to its default value */
+    I2C_cacheInvalidateAll(devAddr);
 }
 /** Get sleep mode status.
  * Setting the SLEEP bit in the register puts the device into very low power
@@ -20,8 +20,13 @@
 #define RET_CMD (50)    // ret command 50us low
 #define BIT_0   (1)     // bit 0
 #define BIT_7   (1<<7)  // bit 0
+#define T1H_NS  (800)   // bit 1 high time
+#define T1L_NS  (450)   // bit 1 low time
+#define T0H_NS  (400)   // bit 0 high time
+#define T0L_NS  (850)   // bit 0 low time
 /*==================[internal data declaration]==============================*/
 gpio_t pin_number;
+uint32_t t1h_cycles, t1l_cycles, t0h_cycles, t0l_cycles;    // bit times in CPU cycles
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -50,280 +55,19 @@ static const uint8_t gamma_table[256] = {
 void IRAM_ATTR ws2812bSendHigh(gpio_t pin){
     GPIOFastWrite(1);
     //delay 0.8us
-    __asm__ __volatile__ ("nop");   // 1
-    __asm__ __volatile__ ("nop");   // 2
-    __asm__ __volatile__ ("nop");   // 3
-    __asm__ __volatile__ ("nop");   // 4
-    __asm__ __volatile__ ("nop");   // 5
-    __asm__ __volatile__ ("nop");   // 6
-    __asm__ __volatile__ ("nop");   // 7
-    __asm__ __volatile__ ("nop");   // 8
-    __asm__ __volatile__ ("nop");   // 9
-    __asm__ __volatile__ ("nop");   // 10
-    __asm__ __volatile__ ("nop");   // 11
-    __asm__ __volatile__ ("nop");   // 12
-    __asm__ __volatile__ ("nop");   // 13
-    __asm__ __volatile__ ("nop");   // 14
-    __asm__ __volatile__ ("nop");   // 15
-    __asm__ __volatile__ ("nop");   // 16
-    __asm__ __volatile__ ("nop");   // 17
-    __asm__ __volatile__ ("nop");   // 18
-    __asm__ __volatile__ ("nop");   // 19
-    __asm__ __volatile__ ("nop");   // 20
-    __asm__ __volatile__ ("nop");   // 21
-    __asm__ __volatile__ ("nop");   // 22
-    __asm__ __volatile__ ("nop");   // 23
-    __asm__ __volatile__ ("nop");   // 24  
-    __asm__ __volatile__ ("nop");   // 25
-    __asm__ __volatile__ ("nop");   // 26
-    __asm__ __volatile__ ("nop");   // 27
-    __asm__ __volatile__ ("nop");   // 28
-    __asm__ __volatile__ ("nop");   // 29
-    __asm__ __volatile__ ("nop");   // 30
-    __asm__ __volatile__ ("nop");   // 31
-    __asm__ __volatile__ ("nop");   // 32
-    __asm__ __volatile__ ("nop");   // 33
-    __asm__ __volatile__ ("nop");   // 34
-    __asm__ __volatile__ ("nop");   // 35
-    __asm__ __volatile__ ("nop");   // 36
-    __asm__ __volatile__ ("nop");   // 37
-    __asm__ __volatile__ ("nop");   // 38
-    __asm__ __volatile__ ("nop");   // 39
-    __asm__ __volatile__ ("nop");   // 40
-    __asm__ __volatile__ ("nop");   // 41
-    __asm__ __volatile__ ("nop");   // 42
-    __asm__ __volatile__ ("nop");   // 43
-    __asm__ __volatile__ ("nop");   // 44
-    __asm__ __volatile__ ("nop");   // 45
-    __asm__ __volatile__ ("nop");   // 46
-    __asm__ __volatile__ ("nop");   // 47
-    __asm__ __volatile__ ("nop");   // 48
-    __asm__ __volatile__ ("nop");   // 49
-    __asm__ __volatile__ ("nop");   // 50
-    __asm__ __volatile__ ("nop");   // 51
-    __asm__ __volatile__ ("nop");   // 52
-    __asm__ __volatile__ ("nop");   // 53
-    __asm__ __volatile__ ("nop");   // 54
-    __asm__ __volatile__ ("nop");   // 55
-    __asm__ __volatile__ ("nop");   // 56
-    __asm__ __volatile__ ("nop");   // 57
-    __asm__ __volatile__ ("nop");   // 58
-    __asm__ __volatile__ ("nop");   // 59
-    __asm__ __volatile__ ("nop");   // 47
-    __asm__ __volatile__ ("nop");   // 50
-    __asm__ __volatile__ ("nop");   // 51
-    __asm__ __volatile__ ("nop");   // 52
-    __asm__ __volatile__ ("nop");   // 53
-    __asm__ __volatile__ ("nop");   // 54
-    __asm__ __volatile__ ("nop");   // 55
-    __asm__ __volatile__ ("nop");   // 56
-    __asm__ __volatile__ ("nop");   // 57
-    __asm__ __volatile__ ("nop");   // 58
-    __asm__ __volatile__ ("nop");   // 59
-    __asm__ __volatile__ ("nop");   // 60
-    __asm__ __volatile__ ("nop");   // 61
-    __asm__ __volatile__ ("nop");   // 62
-    __asm__ __volatile__ ("nop");   // 63
-    __asm__ __volatile__ ("nop");   // 64
-    __asm__ __volatile__ ("nop");   // 65
-    __asm__ __volatile__ ("nop");   // 66
-    __asm__ __volatile__ ("nop");   // 67
-    __asm__ __volatile__ ("nop");   // 68
-    __asm__ __volatile__ ("nop");   // 69
-    __asm__ __volatile__ ("nop");   // 70
-    __asm__ __volatile__ ("nop");   // 71
-    __asm__ __volatile__ ("nop");   // 72
-    __asm__ __volatile__ ("nop");   // 73
-    __asm__ __volatile__ ("nop");   // 74
-    __asm__ __volatile__ ("nop");   // 75
-    __asm__ __volatile__ ("nop");   // 76
-    __asm__ __volatile__ ("nop");   // 77
-    __asm__ __volatile__ ("nop");   // 78
-    __asm__ __volatile__ ("nop");   // 79
-    __asm__ __volatile__ ("nop");   // 80
-    __asm__ __volatile__ ("nop");   // 81
-    __asm__ __volatile__ ("nop");   // 82
-    __asm__ __volatile__ ("nop");   // 83
-    __asm__ __volatile__ ("nop");   // 84
-    __asm__ __volatile__ ("nop");   // 85
-    __asm__ __volatile__ ("nop");   // 86
-    __asm__ __volatile__ ("nop");   // 87
-    __asm__ __volatile__ ("nop");   // 88
-    __asm__ __volatile__ ("nop");   // 89
-    __asm__ __volatile__ ("nop");   // 90
-    __asm__ __volatile__ ("nop");   // 91
-    
+    DelayCycles(t1h_cycles);
     GPIOFastWrite(0);
 	//delay 0.45us
-    __asm__ __volatile__ ("nop");   // 1
-    __asm__ __volatile__ ("nop");   // 2
-    __asm__ __volatile__ ("nop");   // 3
-    __asm__ __volatile__ ("nop");   // 4
-    __asm__ __volatile__ ("nop");   // 5
-    __asm__ __volatile__ ("nop");   // 6
-    __asm__ __volatile__ ("nop");   // 7
-    __asm__ __volatile__ ("nop");   // 8
-    __asm__ __volatile__ ("nop");   // 9
-    __asm__ __volatile__ ("nop");   // 10
-    __asm__ __volatile__ ("nop");   // 11
-    __asm__ __volatile__ ("nop");   // 12
-    __asm__ __volatile__ ("nop");   // 13
-    __asm__ __volatile__ ("nop");   // 14
-    __asm__ __volatile__ ("nop");   // 15
-    __asm__ __volatile__ ("nop");   // 16
-    __asm__ __volatile__ ("nop");   // 17
-    __asm__ __volatile__ ("nop");   // 18
-    __asm__ __volatile__ ("nop");   // 19
-    __asm__ __volatile__ ("nop");   // 20
-    __asm__ __volatile__ ("nop");   // 21
-    __asm__ __volatile__ ("nop");   // 22
-    __asm__ __volatile__ ("nop");   // 23
-    __asm__ __volatile__ ("nop");   // 24  
-    __asm__ __volatile__ ("nop");   // 25
-    __asm__ __volatile__ ("nop");   // 26
-    __asm__ __volatile__ ("nop");   // 27
-    __asm__ __volatile__ ("nop");   // 28
-    __asm__ __volatile__ ("nop");   // 29
+    DelayCycles(t1l_cycles);
 }
 
 void IRAM_ATTR ws2812bSendLow(gpio_t pin){
     GPIOFastWrite(1);
     //delay 0.4us
-    __asm__ __volatile__ ("nop");   // 1
-    __asm__ __volatile__ ("nop");   // 2
-    __asm__ __volatile__ ("nop");   // 3
-    __asm__ __volatile__ ("nop");   // 4
-    __asm__ __volatile__ ("nop");   // 5
-    __asm__ __volatile__ ("nop");   // 6
-    __asm__ __volatile__ ("nop");   // 7
-    __asm__ __volatile__ ("nop");   // 8
-    __asm__ __volatile__ ("nop");   // 9
-    __asm__ __volatile__ ("nop");   // 10
-    __asm__ __volatile__ ("nop");   // 11
-    __asm__ __volatile__ ("nop");   // 12
-    __asm__ __volatile__ ("nop");   // 13
-    __asm__ __volatile__ ("nop");   // 14
-    __asm__ __volatile__ ("nop");   // 15
-    __asm__ __volatile__ ("nop");   // 16
-    __asm__ __volatile__ ("nop");   // 17
-    __asm__ __volatile__ ("nop");   // 18
-    __asm__ __volatile__ ("nop");   // 19
-    __asm__ __volatile__ ("nop");   // 20
-    __asm__ __volatile__ ("nop");   // 21
-    __asm__ __volatile__ ("nop");   // 22
-    __asm__ __volatile__ ("nop");   // 23
-    __asm__ __volatile__ ("nop");   // 24  
-    __asm__ __volatile__ ("nop");   // 25
-    __asm__ __volatile__ ("nop");   // 26
-    __asm__ __volatile__ ("nop");   // 27
-
+    DelayCycles(t0h_cycles);
     GPIOFastWrite(0);
 	//delay 0.85us
-    __asm__ __volatile__ ("nop");   // 1
-    __asm__ __volatile__ ("nop");   // 2
-    __asm__ __volatile__ ("nop");   // 3
-    __asm__ __volatile__ ("nop");   // 4
-    __asm__ __volatile__ ("nop");   // 5
-    __asm__ __volatile__ ("nop");   // 6
-    __asm__ __volatile__ ("nop");   // 7
-    __asm__ __volatile__ ("nop");   // 8
-    __asm__ __volatile__ ("nop");   // 9
-    __asm__ __volatile__ ("nop");   // 10
-    __asm__ __volatile__ ("nop");   // 11
-    __asm__ __volatile__ ("nop");   // 12
-    __asm__ __volatile__ ("nop");   // 13
-    __asm__ __volatile__ ("nop");   // 14
-    __asm__ __volatile__ ("nop");   // 15
-    __asm__ __volatile__ ("nop");   // 16
-    __asm__ __volatile__ ("nop");   // 17
-    __asm__ __volatile__ ("nop");   // 18
-    __asm__ __volatile__ ("nop");   // 19
-    __asm__ __volatile__ ("nop");   // 20
-    __asm__ __volatile__ ("nop");   // 21
-    __asm__ __volatile__ ("nop");   // 22
-    __asm__ __volatile__ ("nop");   // 23
-    __asm__ __volatile__ ("nop");   // 24  
-    __asm__ __volatile__ ("nop");   // 25
-    __asm__ __volatile__ ("nop");   // 26
-    __asm__ __volatile__ ("nop");   // 27
-    __asm__ __volatile__ ("nop");   // 28
-    __asm__ __volatile__ ("nop");   // 29
-    __asm__ __volatile__ ("nop");   // 30
-    __asm__ __volatile__ ("nop");   // 31
-    __asm__ __volatile__ ("nop");   // 32
-    __asm__ __volatile__ ("nop");   // 33
-    __asm__ __volatile__ ("nop");   // 34
-    __asm__ __volatile__ ("nop");   // 35
-    __asm__ __volatile__ ("nop");   // 36
-    __asm__ __volatile__ ("nop");   // 37
-    __asm__ __volatile__ ("nop");   // 38
-    __asm__ __volatile__ ("nop");   // 39
-    __asm__ __volatile__ ("nop");   // 40
-    __asm__ __volatile__ ("nop");   // 41
-    __asm__ __volatile__ ("nop");   // 42
-    __asm__ __volatile__ ("nop");   // 43
-    __asm__ __volatile__ ("nop");   // 44
-    __asm__ __volatile__ ("nop");   // 45
-    __asm__ __volatile__ ("nop");   // 46
-    __asm__ __volatile__ ("nop");   // 47
-    __asm__ __volatile__ ("nop");   // 48
-    __asm__ __volatile__ ("nop");   // 49
-    __asm__ __volatile__ ("nop");   // 50
-    __asm__ __volatile__ ("nop");   // 51
-    __asm__ __volatile__ ("nop");   // 52
-    __asm__ __volatile__ ("nop");   // 53
-    __asm__ __volatile__ ("nop");   // 54
-    __asm__ __volatile__ ("nop");   // 55
-    __asm__ __volatile__ ("nop");   // 56
-    __asm__ __volatile__ ("nop");   // 57
-    __asm__ __volatile__ ("nop");   // 58
-    __asm__ __volatile__ ("nop");   // 59
-    __asm__ __volatile__ ("nop");   // 47
-    __asm__ __volatile__ ("nop");   // 50
-    __asm__ __volatile__ ("nop");   // 51
-    __asm__ __volatile__ ("nop");   // 52
-    __asm__ __volatile__ ("nop");   // 53
-    __asm__ __volatile__ ("nop");   // 54
-    __asm__ __volatile__ ("nop");   // 55
-    __asm__ __volatile__ ("nop");   // 56
-    __asm__ __volatile__ ("nop");   // 57
-    __asm__ __volatile__ ("nop");   // 58
-    __asm__ __volatile__ ("nop");   // 59
-    __asm__ __volatile__ ("nop");   // 60
-    __asm__ __volatile__ ("nop");   // 61
-    __asm__ __volatile__ ("nop");   // 62
-    __asm__ __volatile__ ("nop");   // 63
-    __asm__ __volatile__ ("nop");   // 64
-    __asm__ __volatile__ ("nop");   // 65
-    __asm__ __volatile__ ("nop");   // 66
-    __asm__ __volatile__ ("nop");   // 67
-    __asm__ __volatile__ ("nop");   // 68
-    __asm__ __volatile__ ("nop");   // 69
-    __asm__ __volatile__ ("nop");   // 70
-    __asm__ __volatile__ ("nop");   // 71
-    __asm__ __volatile__ ("nop");   // 72
-    __asm__ __volatile__ ("nop");   // 73
-    __asm__ __volatile__ ("nop");   // 74
-    __asm__ __volatile__ ("nop");   // 75
-    __asm__ __volatile__ ("nop");   // 76
-    __asm__ __volatile__ ("nop");   // 77
-    __asm__ __volatile__ ("nop");   // 78
-    __asm__ __volatile__ ("nop");   // 79
-    __asm__ __volatile__ ("nop");   // 80
-    __asm__ __volatile__ ("nop");   // 81
-    __asm__ __volatile__ ("nop");   // 82
-    __asm__ __volatile__ ("nop");   // 83
-    __asm__ __volatile__ ("nop");   // 84
-    __asm__ __volatile__ ("nop");   // 85
-    __asm__ __volatile__ ("nop");   // 86
-    __asm__ __volatile__ ("nop");   // 87
-    __asm__ __volatile__ ("nop");   // 88
-    __asm__ __volatile__ ("nop");   // 89
-    __asm__ __volatile__ ("nop");   // 90
-    __asm__ __volatile__ ("nop");   // 91
-    __asm__ __volatile__ ("nop");   // 92
-    __asm__ __volatile__ ("nop");   // 93
-    __asm__ __volatile__ ("nop");   // 94
+    DelayCycles(t0l_cycles);
 }
 
 uint8_t ws2812bGammaCorrection(uint8_t component){
@@ -335,10 +79,16 @@ uint8_t ws2812bGammaCorrection(uint8_t component){
 void ws2812bInit(gpio_t pin){
     pin_number = pin;
     GPIOFastInit(&pin, 1);
+    DelayCyclesCalibrate();
 }
 
 void ws2812bSend(rgb_led_t led_color){
     uint8_t i;
+    // bit times are converted on each send, in case CPU frequency changed
+    t1h_cycles = DelayNsToCycles(T1H_NS);
+    t1l_cycles = DelayNsToCycles(T1L_NS);
+    t0h_cycles = DelayNsToCycles(T0H_NS);
+    t0l_cycles = DelayNsToCycles(T0L_NS);
 	// Blue
 	for(i=0; i<=7; i++){
         if(ws2812bGammaCorrection(led_color.green) & (BIT_7>>i)){
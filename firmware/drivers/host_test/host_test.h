@@ -0,0 +1,41 @@
+/**
+ * @file host_test.h
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Minimal check macros for the driver tests that run on the host (PC)
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+/*==================[macros]=================================================*/
+static unsigned host_test_checks = 0;	/*!< Checks evaluated */
+static unsigned host_test_failed = 0;	/*!< Checks failed */
+
+/**
+ * @brief Evaluates cond, printing file and line when it fails
+ */
+#define CHECK(cond) do { \
+		host_test_checks++; \
+		if(!(cond)){ \
+			host_test_failed++; \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while(0)
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Prints the summary of the test
+ *
+ * @param name Module under test
+ * @return Process exit code (0: all checks passed)
+ */
+static inline int HostTestResult(const char *name){
+	printf("%s: %u checks, %u failed\n", name, host_test_checks, host_test_failed);
+	return host_test_failed ? 1 : 0;
+}
+#endif /* HOST_TEST_H */
+/*==================[end of file]============================================*/
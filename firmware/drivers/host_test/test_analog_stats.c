@@ -0,0 +1,132 @@
+/**
+ * @file test_analog_stats.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of analog_stats_mcu: jitter and latency percentiles with a fake clock
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include "analog_stats_mcu.h"
+#include "host_test.h"
+/*==================[macros and definitions]=================================*/
+#define PERIOD			1000		/*!< Nominal interval between events (in us) */
+#define BIN_WIDTH		10			/*!< Histogram bin width (in us) */
+/*==================[internal data definition]===============================*/
+static uint64_t fake_now = 5000;	/*!< Time returned by FakeClock() (in us) */
+/*==================[internal functions definition]==========================*/
+static uint64_t FakeClock(void){
+	return fake_now;
+}
+
+/**
+ * @brief Advance the fake clock by one period plus deviation and timestamp an event
+ */
+static void Event(analog_timing_t *timing, int32_t deviation){
+	fake_now += PERIOD + deviation;
+	AnalogTimingEvent(timing);
+}
+
+static void TestJitter(void){
+	analog_timing_t timing;
+	analog_stats_t stats;
+	AnalogTimingInit(&timing, FakeClock, PERIOD, BIN_WIDTH);
+	/* the first event only starts the interval */
+	AnalogTimingEvent(&timing);
+	CHECK(timing.hist[ANALOG_HIST_JITTER].count == 0);
+	/* 50 on time, 40 late by 25 us, 9 late by 55 us, 1 late by 300 us */
+	for(uint8_t i = 0; i < 50; i++){
+		Event(&timing, 0);
+	}
+	for(uint8_t i = 0; i < 40; i++){
+		Event(&timing, 25);
+	}
+	for(uint8_t i = 0; i < 9; i++){
+		Event(&timing, 55);
+	}
+	Event(&timing, 300);
+	stats = timing.hist[ANALOG_HIST_JITTER];
+	AnalogStatsSummary(&stats);
+	CHECK(stats.count == 100);
+	CHECK(stats.min == 0);
+	CHECK(stats.max == 300);
+	/* percentiles are the upper edge of their bin */
+	CHECK(stats.p50 == 10);
+	CHECK(stats.p90 == 30);
+	CHECK(stats.p99 == 60);
+	CHECK(AnalogStatsPercentile(&stats, 100) == 300);
+	/* early events fall below 0 */
+	AnalogTimingInit(&timing, FakeClock, PERIOD, BIN_WIDTH);
+	AnalogTimingEvent(&timing);
+	for(uint8_t i = 0; i < 10; i++){
+		Event(&timing, -15);
+	}
+	stats = timing.hist[ANALOG_HIST_JITTER];
+	AnalogStatsSummary(&stats);
+	CHECK(stats.min == -15 && stats.max == -15);
+	CHECK(stats.p50 == -15 && stats.p99 == -15);
+}
+
+static void TestOutOfRange(void){
+	analog_timing_t timing;
+	analog_stats_t stats;
+	AnalogTimingInit(&timing, FakeClock, PERIOD, BIN_WIDTH);
+	AnalogTimingEvent(&timing);
+	/* beyond both edges of the jitter histogram (-320 to 320 us) */
+	for(uint8_t i = 0; i < 10; i++){
+		Event(&timing, 800);
+	}
+	stats = timing.hist[ANALOG_HIST_JITTER];
+	AnalogStatsSummary(&stats);
+	CHECK(stats.bins[ANALOG_HIST_BINS - 1] == 10);
+	CHECK(stats.p50 == 800 && stats.p99 == 800);
+	AnalogTimingInit(&timing, FakeClock, PERIOD, BIN_WIDTH);
+	AnalogTimingEvent(&timing);
+	for(uint8_t i = 0; i < 10; i++){
+		Event(&timing, -600);
+	}
+	stats = timing.hist[ANALOG_HIST_JITTER];
+	AnalogStatsSummary(&stats);
+	CHECK(stats.bins[0] == 10);
+	CHECK(stats.p50 == -600 && stats.p99 == -600);
+	/* no measures */
+	AnalogTimingInit(&timing, FakeClock, PERIOD, 0);
+	stats = timing.hist[ANALOG_HIST_LATENCY];
+	AnalogStatsSummary(&stats);
+	CHECK(stats.bin_width == 1);
+	CHECK(stats.p50 == 0 && stats.p99 == 0);
+}
+
+static void TestLatency(void){
+	analog_timing_t timing;
+	analog_stats_t stats;
+	AnalogTimingInit(&timing, FakeClock, PERIOD, BIN_WIDTH);
+	/* frames taken 0 to 99 us after they were ready */
+	for(uint8_t i = 0; i < 100; i++){
+		uint64_t ready = fake_now;
+		fake_now += i;
+		AnalogTimingLatency(&timing, ready);
+		fake_now += PERIOD;
+	}
+	stats = timing.hist[ANALOG_HIST_LATENCY];
+	AnalogStatsSummary(&stats);
+	CHECK(stats.count == 100);
+	CHECK(stats.min == 0 && stats.max == 99);
+	CHECK(stats.p50 == 50);
+	CHECK(stats.p90 == 90);
+	CHECK(stats.p99 == 99);
+	/* latency is not affected by the jitter histogram and vice versa */
+	CHECK(timing.hist[ANALOG_HIST_JITTER].count == 0);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TestJitter();
+	TestOutOfRange();
+	TestLatency();
+	return HostTestResult("analog_stats_mcu");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,196 @@
+/**
+ * @file test_format_mcu.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of format_mcu against snprintf, with a conversion time comparison
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include "format_mcu.h"
+#include "host_test.h"
+/*==================[macros and definitions]=================================*/
+#define RANDOM_VALUES	200000		/*!< Random values checked by each test */
+#define BENCH_CALLS		2000000		/*!< Conversions timed by the benchmark */
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Random 32 bit value, with every magnitude equally likely
+ */
+static uint32_t Random32(void){
+	uint32_t val = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+	return val >> (rand() % 32);
+}
+
+/**
+ * @brief Reference conversion to any base (digit by digit)
+ */
+static void RefBase(uint32_t val, uint8_t base, char *buf){
+	char tmp[33];
+	uint8_t i = sizeof(tmp);
+	tmp[--i] = '\0';
+	do{
+		tmp[--i] = "0123456789abcdef"[val % base];
+		val /= base;
+	}while(val);
+	strcpy(buf, &tmp[i]);
+}
+
+static void TestIntegers(void){
+	const uint32_t edges[] = {0, 1, 9, 10, 99, 100, 999, 1000, 99999, 100000, 999999999, 1000000000,
+		INT32_MAX, (uint32_t)INT32_MAX + 1, UINT32_MAX - 1, UINT32_MAX};
+	char buf[FORMAT_BIN_SIZE], ref[FORMAT_BIN_SIZE];
+	srand(2);
+	for(uint32_t n = 0; n < RANDOM_VALUES; n++){
+		uint32_t val = (n < sizeof(edges) / sizeof(edges[0])) ? edges[n] : Random32();
+		CHECK(FormatUint32(val, buf) == snprintf(ref, sizeof(ref), "%" PRIu32, val));
+		CHECK(strcmp(buf, ref) == 0);
+		CHECK(FormatInt32((int32_t)val, buf) == snprintf(ref, sizeof(ref), "%" PRId32, (int32_t)val));
+		CHECK(strcmp(buf, ref) == 0);
+		CHECK(FormatUint32Base(val, 16, buf) == snprintf(ref, sizeof(ref), "%" PRIx32, val));
+		CHECK(strcmp(buf, ref) == 0);
+		CHECK(FormatUint32Base(val, 8, buf) == snprintf(ref, sizeof(ref), "%" PRIo32, val));
+		CHECK(strcmp(buf, ref) == 0);
+		for(uint8_t base = 2; base <= 16; base++){
+			RefBase(val, base, ref);
+			CHECK(FormatUint32Base(val, base, buf) == strlen(ref));
+			CHECK(strcmp(buf, ref) == 0);
+		}
+	}
+	/* out of range bases give an empty string */
+	const uint8_t bad_bases[] = {0, 1, 17, 36, 255};
+	for(uint8_t i = 0; i < sizeof(bad_bases); i++){
+		strcpy(buf, "x");
+		CHECK(FormatUint32Base(1234, bad_bases[i], buf) == 0);
+		CHECK(buf[0] == '\0');
+	}
+}
+
+static void TestFixed(void){
+	char buf[FORMAT_INT_SIZE + 1], ref[32];
+	const uint32_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+	srand(3);
+	for(uint32_t n = 0; n < RANDOM_VALUES; n++){
+		int32_t val = (int32_t)Random32();
+		if(n & 1){
+			val = -val;
+		}
+		uint8_t decimals = n % 10;
+		uint32_t abs_val = (val < 0) ? -(uint32_t)val : (uint32_t)val;
+		if(decimals == 0){
+			snprintf(ref, sizeof(ref), "%" PRId32, val);
+		} else {
+			snprintf(ref, sizeof(ref), "%s%" PRIu32 ".%0*" PRIu32, (val < 0) ? "-" : "",
+				abs_val / pow10[decimals], decimals, abs_val % pow10[decimals]);
+		}
+		CHECK(FormatFixed(val, decimals, buf) == strlen(ref));
+		CHECK(strcmp(buf, ref) == 0);
+	}
+}
+
+static void TestFloat(void){
+	char buf[FORMAT_FLOAT_SIZE], ref[64];
+	srand(4);
+	for(uint32_t n = 0; n < RANDOM_VALUES; n++){
+		float val = (float)Random32() / (float)(1 << (rand() % 24));
+		if(n & 1){
+			val = -val;
+		}
+		uint8_t decimals = n % 7;
+		uint8_t length = FormatFloat(val, decimals, buf);
+		snprintf(ref, sizeof(ref), "%.*f", decimals, val);
+		CHECK(length == strlen(buf));
+		CHECK(length < FORMAT_FLOAT_SIZE);
+		/* FormatFloat rounds in single precision: it may differ from snprintf in the last digit */
+		double diff = strtod(buf, NULL) - strtod(ref, NULL);
+		double unit = 1.0;
+		for(uint8_t d = 0; d < decimals; d++){
+			unit /= 10;
+		}
+		double tolerance = unit * 1.01 + ((val > 16777216.0f || val < -16777216.0f) ? 1.0 : 0.0);
+		CHECK(diff <= tolerance && diff >= -tolerance);
+	}
+	/* exact values */
+	CHECK(FormatFloat(0.0f, 2, buf) == 4 && strcmp(buf, "0.00") == 0);
+	CHECK(FormatFloat(-1.5f, 1, buf) == 4 && strcmp(buf, "-1.5") == 0);
+	CHECK(FormatFloat(9.999f, 2, buf) == 5 && strcmp(buf, "10.00") == 0);
+	CHECK(FormatFloat(5e9f, 2, buf) == 3 && strcmp(buf, "ovf") == 0);
+	CHECK(FormatFloat(0.0f / 0.0f, 2, buf) == 3 && strcmp(buf, "nan") == 0);
+}
+
+static void TestCsv(void){
+	int16_t ch0[100], ch1[100], ch2[100];
+	const int16_t *blocks[3] = {ch0, ch1, ch2};
+	char buf[4096], ref[4096];
+	uint16_t ref_length = 0;
+	srand(5);
+	for(uint8_t i = 0; i < 100; i++){
+		ch0[i] = rand();
+		ch1[i] = -rand();
+		ch2[i] = (i == 0) ? INT16_MIN : (i == 1) ? INT16_MAX : 0;
+		ref_length += snprintf(&ref[ref_length], sizeof(ref) - ref_length, "%d,%d,%d" FORMAT_CSV_EOL, ch0[i], ch1[i], ch2[i]);
+	}
+	CHECK(FormatCsv(blocks, 3, 100, buf, sizeof(buf)) == ref_length);
+	CHECK(strcmp(buf, ref) == 0);
+	/* only complete lines fit in a small buffer */
+	uint16_t length = FormatCsv(blocks, 3, 100, buf, 100);
+	CHECK(length < 100);
+	CHECK(length > 0 && buf[length - 1] == '\n');
+	CHECK(strncmp(buf, ref, length) == 0);
+	/* nothing to write */
+	CHECK(FormatCsv(blocks, 0, 100, buf, sizeof(buf)) == 0);
+	CHECK(FormatCsv(blocks, 3, 0, buf, sizeof(buf)) == 0);
+}
+
+/**
+ * @brief Compares conversion time with snprintf on the host (only a reference: measure on the board)
+ */
+static void BenchFormat(void){
+	static uint32_t values[1024];
+	char buf[FORMAT_FLOAT_SIZE];
+	volatile uint32_t sink = 0;
+	clock_t start;
+	double t_format, t_snprintf;
+	for(uint16_t i = 0; i < 1024; i++){
+		values[i] = Random32();
+	}
+	start = clock();
+	for(uint32_t n = 0; n < BENCH_CALLS; n++){
+		sink += FormatInt32((int32_t)values[n & 1023], buf);
+	}
+	t_format = (double)(clock() - start) / CLOCKS_PER_SEC;
+	start = clock();
+	for(uint32_t n = 0; n < BENCH_CALLS; n++){
+		sink += snprintf(buf, sizeof(buf), "%" PRId32, (int32_t)values[n & 1023]);
+	}
+	t_snprintf = (double)(clock() - start) / CLOCKS_PER_SEC;
+	printf("FormatInt32 %.1f ns/call, snprintf %.1f ns/call\n", t_format * 1e9 / BENCH_CALLS, t_snprintf * 1e9 / BENCH_CALLS);
+	start = clock();
+	for(uint32_t n = 0; n < BENCH_CALLS; n++){
+		sink += FormatFloat((float)values[n & 1023] / 1000.0f, 3, buf);
+	}
+	t_format = (double)(clock() - start) / CLOCKS_PER_SEC;
+	start = clock();
+	for(uint32_t n = 0; n < BENCH_CALLS; n++){
+		sink += snprintf(buf, sizeof(buf), "%.3f", (float)values[n & 1023] / 1000.0f);
+	}
+	t_snprintf = (double)(clock() - start) / CLOCKS_PER_SEC;
+	printf("FormatFloat %.1f ns/call, snprintf %.1f ns/call\n", t_format * 1e9 / BENCH_CALLS, t_snprintf * 1e9 / BENCH_CALLS);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TestIntegers();
+	TestFixed();
+	TestFloat();
+	TestCsv();
+	BenchFormat();
+	return HostTestResult("format_mcu");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,169 @@
+/**
+ * @file test_telemetry_mcu.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief Host test of telemetry_mcu: CRC, COBS round trip and frame loopback through a fake UART
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "telemetry_mcu.h"
+#include "host_test.h"
+/*==================[macros and definitions]=================================*/
+#define LINE_SIZE		16384		/*!< Bytes captured by the fake UART */
+/*==================[internal data definition]===============================*/
+static uint8_t line[LINE_SIZE];		/*!< Bytes "sent" through the fake UART */
+static uint32_t line_length = 0;	/*!< Bytes in line */
+static uint32_t line_room = LINE_SIZE;	/*!< Free bytes reported by the fake UART */
+static uint8_t work[LINE_SIZE];		/*!< Copy of line (TelemetryDecode() decodes in place) */
+/*==================[fake uart_mcu]===========================================*/
+bool UartSendFrameAsync(uart_mcu_port_t port, const char *data, uint16_t nbytes){
+	if((nbytes > line_room) || (line_length + nbytes > LINE_SIZE)){
+		return false;
+	}
+	memcpy(&line[line_length], data, nbytes);
+	line_length += nbytes;
+	line_room -= nbytes;
+	return true;
+}
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Split the captured stream on 0x00 and decode every frame, as the PC does
+ *
+ * @param frames Decoded frames
+ * @param samples Samples of the decoded frames (channel-major, copied)
+ * @param max Size of frames and samples
+ * @return Number of valid frames
+ */
+static uint16_t LineDecode(telemetry_frame_t *frames, int16_t samples[][TELEMETRY_PAYLOAD_MAX / 2], uint16_t max){
+	uint16_t qty = 0;
+	uint32_t start = 0;
+	memcpy(work, line, line_length);
+	for(uint32_t i = 0; i < line_length; i++){
+		if(line[i] != 0){
+			continue;
+		}
+		if((i > start) && (qty < max) && TelemetryDecode(&work[start], i - start, &frames[qty])){
+			for(uint16_t j = 0; j < frames[qty].channel_qty * frames[qty].length; j++){
+				samples[qty][j] = (int16_t)(frames[qty].payload[2 * j] | (frames[qty].payload[2 * j + 1] << 8));
+			}
+			qty++;
+		}
+		start = i + 1;
+	}
+	return qty;
+}
+
+static void TestCrc(void){
+	const uint8_t check[] = "123456789";
+	/* CRC-16/CCITT-FALSE check value */
+	CHECK(TelemetryCrc16(check, 9) == 0x29B1);
+	CHECK(TelemetryCrc16(check, 0) == 0xFFFF);
+}
+
+static void TestCobs(void){
+	static uint8_t src[1200], enc[TELEMETRY_COBS_MAX(1200)], dec[1200];
+	const uint16_t lengths[] = {0, 1, 2, 253, 254, 255, 256, 508, 509, 1200};
+	srand(1);
+	for(uint8_t pattern = 0; pattern < 4; pattern++){
+		for(uint8_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++){
+			uint16_t length = lengths[l];
+			for(uint16_t i = 0; i < length; i++){
+				switch(pattern){
+					case 0: src[i] = 0; break;						/* only zeros */
+					case 1: src[i] = 1 + (i % 255); break;			/* no zeros (full blocks) */
+					case 2: src[i] = rand() & 0xFF; break;			/* random */
+					default: src[i] = (i % 7 == 0) ? 0 : 0x5A; break;	/* sparse zeros */
+				}
+			}
+			uint16_t enc_length = TelemetryCobsEncode(src, length, enc);
+			CHECK(enc_length <= TELEMETRY_COBS_MAX(length));
+			CHECK(memchr(enc, 0, enc_length) == NULL);
+			CHECK(TelemetryCobsDecode(enc, enc_length, dec) == length);
+			CHECK(memcmp(src, dec, length) == 0);
+		}
+	}
+	/* a code pointing past the end is rejected */
+	const uint8_t bad[] = {5, 1, 2};
+	CHECK(TelemetryCobsDecode(bad, sizeof(bad), dec) == 0);
+}
+
+static void TestLoopback(void){
+	static telemetry_frame_t frames[64];
+	static int16_t samples[64][TELEMETRY_PAYLOAD_MAX / 2];
+	telemetry_config_t config = {
+		.port = UART_CONNECTOR,
+		.channel_qty = 3,
+		.batch = 10,
+	};
+	int16_t values[3];
+	line_length = 0;
+	line_room = LINE_SIZE;
+	TelemetryInit(&config);
+	/* 5 frames of 10 samples, with zeros and negative values in the payload */
+	for(uint16_t n = 0; n < 50; n++){
+		values[0] = n;
+		values[1] = -n;
+		values[2] = (n % 3) ? 0x0100 * n : 0;
+		CHECK(TelemetryPush(values));
+	}
+	uint16_t qty = LineDecode(frames, samples, 64);
+	CHECK(qty == 5);
+	for(uint16_t f = 0; f < qty; f++){
+		CHECK(frames[f].sequence == f);
+		CHECK(frames[f].channel_qty == 3);
+		CHECK(frames[f].length == 10);
+		for(uint16_t i = 0; i < 10; i++){
+			uint16_t n = 10 * f + i;
+			CHECK(samples[f][i] == (int16_t)n);
+			CHECK(samples[f][10 + i] == (int16_t)-n);
+			CHECK(samples[f][20 + i] == (int16_t)((n % 3) ? 0x0100 * n : 0));
+		}
+	}
+	/* a corrupted byte only loses its own frame */
+	line[30] ^= 0x40;
+	CHECK(LineDecode(frames, samples, 64) == 4);
+}
+
+static void TestDrop(void){
+	static telemetry_frame_t frames[64];
+	static int16_t samples[64][TELEMETRY_PAYLOAD_MAX / 2];
+	const int16_t block[4] = {1, 2, 3, 4};
+	const int16_t *blocks[1] = {block};
+	telemetry_config_t config = {
+		.port = UART_CONNECTOR,
+		.channel_qty = 1,
+		.batch = 4,
+	};
+	line_length = 0;
+	line_room = LINE_SIZE;
+	TelemetryInit(&config);
+	CHECK(TelemetrySendBlocks(blocks, 4));
+	/* no room for a whole frame: nothing is sent, the frame is counted as dropped */
+	uint32_t before = line_length;
+	line_room = 5;
+	CHECK(!TelemetrySendBlocks(blocks, 4));
+	CHECK(line_length == before);
+	CHECK(TelemetryDropped() == 1);
+	line_room = LINE_SIZE;
+	CHECK(TelemetrySendBlocks(blocks, 4));
+	/* the receiver sees a sequence gap, not a truncated frame */
+	CHECK(LineDecode(frames, samples, 64) == 2);
+	CHECK(frames[0].sequence == 0);
+	CHECK(frames[1].sequence == 2);
+}
+/*==================[external functions definition]==========================*/
+int main(void){
+	TestCrc();
+	TestCobs();
+	TestLoopback();
+	TestDrop();
+	return HostTestResult("telemetry_mcu");
+}
+/*==================[end of file]============================================*/
@@ -13,6 +13,9 @@
  * 
  * @note The ESP-EDU have 4 analog inputs and 1 analog output, but the designated pin for 
  * the latter is shared with analog output 0 (CH0).
+ * 
+ * @note Single and continuous modes share the same ADC unit, so single reads will fail 
+ * while a continuous conversion is running.
  *
  * @author Albano Peñalva
  *
@@ -21,11 +24,25 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 24/02/2024 | Document creation		                         						|
+ * | 16/10/2026 | Continuous (DMA) mode implementation									|
+ * | 16/10/2026 | Multi-channel scan acquisition										|
+ * | 16/10/2026 | Frame lending API														|
+ * | 16/10/2026 | Calibration tables (raw to mV)										|
+ * | 16/10/2026 | Analog clock (synchronous ADC sampling and DAC update)				|
+ * | 16/10/2026 | Waveform players													|
+ * | 16/10/2026 | Acquisition timestamps and jitter/latency statistics					|
+ * | 16/10/2026 | Q15 scan format														|
+ * | 17/10/2026 | Player rate limited to the analog clock rate							|
+ * | 17/10/2026 | Statistics maths moved to analog_stats_mcu							|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "analog_stats_mcu.h"
 /*==================[macros]=================================================*/
 typedef enum adc_ch {
 	CH0 = 0,				/*!< Channel 0 */
@@ -39,7 +56,35 @@ typedef enum adc_mode {
 	ADC_CONTINUOUS,			/*!< Continuous read */
 } adc_mode_t;
 
+typedef enum analog_player_num {
+	PLAYER_0 = 0,			/*!< Player 0 */
+	PLAYER_1,				/*!< Player 1 */
+	PLAYER_2,				/*!< Player 2 */
+	PLAYER_3				/*!< Player 3 */
+} analog_player_num_t;
+
+typedef enum analog_player_mode {
+	PLAYER_ONE_SHOT,		/*!< Play the buffer once */
+	PLAYER_LOOP,			/*!< Play the buffer continuously */
+	PLAYER_STREAM,			/*!< Play the buffer continuously, refilling each half after it is played */
+} analog_player_mode_t;
+
+typedef enum adc_format {
+	ADC_FORMAT_U16,			/*!< uint16_t raw values (0 to 4095) */
+	ADC_FORMAT_S16,			/*!< int16_t values centered on ADC_MID_SCALE (-2048 to 2047) */
+	ADC_FORMAT_Q15,			/*!< int16_t values centered on ADC_MID_SCALE and scaled to Q15 (-32768 to 32752), 
+								 ready for esp-dsp s16 functions */
+} adc_format_t;
+
 #define DAC	0    			/*!< DAC pin. Override CH0 declaration*/
+
+#define ADC_CONT_FRAME_SIZE_DEFAULT	256		/*!< Default samples per frame in continuous mode */
+#define ADC_CONT_FRAME_SIZE_MAX		1024	/*!< Maximum samples per frame in continuous mode (adding all channels) */
+#define ADC_CONT_FRAME_QTY			4		/*!< Frames stored by the driver in continuous mode */
+#define ADC_SCAN_CH_MAX				4		/*!< Maximum number of channels in a scan */
+#define ADC_MID_SCALE				2048	/*!< Raw value subtracted in ADC_FORMAT_S16 and ADC_FORMAT_Q15 blocks */
+#define ANALOG_CLOCK_BLOCK_MAX		512		/*!< Maximum samples per analog clock block */
+#define ANALOG_PLAYER_QTY			4		/*!< Waveform players (one per SDM channel) */
 /*==================[typedef]================================================*/
 /**
  * @brief Analog inputs config structure
@@ -50,9 +95,69 @@ typedef struct {
 	adc_mode_t mode;		/*!< Mode: single read or continuous read */
 	void *func_p;			/*!< Pointer to callback function for convertion end (only for continuous mode) */
 	void *param_p;			/*!< Pointer to callback function parameters (only for continuous mode) */
-	uint16_t sample_frec;	/*!< Sample frequency min: 20kHz - max: 2MHz (only for continuous mode)  */
+	uint32_t sample_frec;	/*!< Sample frequency min: 611Hz - max: 83333Hz (only for continuous mode)  */
+	uint16_t frame_size;	/*!< Samples per frame, 0 for ADC_CONT_FRAME_SIZE_DEFAULT (only for continuous mode) */
+	bool calibrated;		/*!< true: values are returned in mV (see AnalogCalibrationInit()) */
 } analog_input_config_t;	
 
+/**
+ * @brief Multi-channel scan config structure
+ * 
+ */
+typedef struct {
+	adc_ch_t *inputs;		/*!< Array of channels to scan (CH0, CH1, CH2, CH3) */
+	uint8_t input_qty;		/*!< Number of channels in inputs (up to ADC_SCAN_CH_MAX) */
+	adc_format_t format;	/*!< Format of the per-channel blocks */
+	void *func_p;			/*!< Pointer to callback function for frame end */
+	void *param_p;			/*!< Pointer to callback function parameters */
+	uint32_t sample_frec;	/*!< Sample frequency of each channel */
+	uint16_t frame_size;	/*!< Samples per channel and frame, 0 for ADC_CONT_FRAME_SIZE_DEFAULT / input_qty */
+	bool calibrated;		/*!< true: values are returned in mV (only for ADC_FORMAT_U16) */
+} analog_scan_config_t;
+
+/**
+ * @brief Frame lent by the driver to the subscribed task
+ * 
+ */
+typedef struct {
+	void *data[ADC_SCAN_CH_MAX];		/*!< Per-channel blocks (uint16_t or int16_t according to format) */
+	adc_ch_t channel[ADC_SCAN_CH_MAX];	/*!< Channel of each block */
+	uint8_t channel_qty;				/*!< Number of blocks */
+	uint16_t length;					/*!< Samples in each block */
+	uint64_t timestamp;					/*!< Time of the first sample (in us, see TimerGetUs()) */
+	uint32_t sequence;					/*!< Frame number since start (gaps indicate lost frames) */
+} analog_frame_t;
+
+/**
+ * @brief Analog clock config structure
+ * 
+ */
+typedef struct {
+	uint32_t sample_frec;	/*!< Clock frequency (in Hz, up to 20kHz) */
+	uint16_t block_size;	/*!< Samples per block (up to ANALOG_CLOCK_BLOCK_MAX) */
+	adc_ch_t input;			/*!< Channel sampled on each tick (initialized in ADC_SINGLE mode) */
+	bool sample_input;		/*!< true: sample input on each tick */
+	bool update_output;		/*!< true: update DAC on each tick (AnalogOutputInit() must be called first) */
+	void *func_p;			/*!< Pointer to callback function for block end (called from ISR) */
+	void *param_p;			/*!< Pointer to callback function parameters */
+} analog_clock_config_t;
+
+/**
+ * @brief Waveform player config structure
+ * 
+ */
+typedef struct {
+	analog_player_num_t player;	/*!< Player number */
+	uint8_t pin;				/*!< GPIO number of the output (one GPIO per player) */
+	analog_player_mode_t mode;	/*!< Play mode */
+	uint32_t sample_frec;		/*!< Samples per second (up to the analog clock frequency) */
+	uint8_t *buffer;			/*!< Samples buffer (values from 0 to 255) */
+	uint16_t length;			/*!< Number of samples in buffer */
+	void *func_p;				/*!< Pointer to callback function (called from ISR) at buffer end in one shot 
+									 mode, or after each half of the buffer in stream mode */
+	void *param_p;				/*!< Pointer to callback function parameters */
+} analog_player_config_t;
+
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -75,14 +180,25 @@ void AnalogOutputInit(void);
  * @brief Read single channel.
  * 
  * @param channel Channel selected
- * @param value Read variable pointer (in mV)
+ * @param value Read variable pointer (in mV if the channel is calibrated, raw value otherwise)
  * @return null
  */
 void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value);
 
+/**
+ * @brief Time of the last single read of a channel.
+ * 
+ * @param channel Channel selected
+ * @return Time at which the conversion was started (in us since boot)
+ */
+uint64_t AnalogInputTimestamp(adc_ch_t channel);
+
 /**
  * @brief Start convertion for ADC module in continuous mode
  * 
+ * Conversions are moved by DMA to a driver-owned ring of ADC_CONT_FRAME_QTY frames. The callback 
+ * set in AnalogInputInit() is called (from ISR) each time a frame is completed.
+ * 
  * @param channel Channel selected
  */
 void AnalogStartContinuous(adc_ch_t channel);
@@ -95,12 +211,115 @@ void AnalogStartContinuous(adc_ch_t channel);
 void AnalogStopContinuous(adc_ch_t channel);
 
 /**
- * @brief 
+ * @brief Pull the oldest completed frame from the driver ring.
+ * 
+ * @note Blocks the calling task until a frame is available.
  * 
  * @param channel Channel selected.
- * @param values Read variable array
+ * @param values Read variable array (of lenght = frame_size)
+ * @return Number of samples stored in values (0 if no frame is available)
+ */
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
+
+/**
+ * @brief Multi-channel scan initialization
+ * 
+ * All channels are converted in a single DMA pattern, so samples with the same index in 
+ * each channel block are time-aligned (one conversion apart).
+ * 
+ * @note Total conversion rate (sample_frec * input_qty) is limited to 83333Hz.
+ * 
+ * @param config Scan config structure
+ */
+void AnalogScanInit(analog_scan_config_t *config);
+
+/**
+ * @brief Start scan conversions
+ * 
+ */
+void AnalogScanStart(void);
+
+/**
+ * @brief Stop scan conversions
+ * 
+ */
+void AnalogScanStop(void);
+
+/**
+ * @brief Pull the oldest completed frame from the driver ring and split it in per-channel blocks.
+ * 
+ * @note Blocks the calling task until a frame is available.
+ * 
+ * @param blocks Array of input_qty pointers (same order as inputs) to uint16_t or int16_t 
+ * arrays (according to format) of lenght = frame_size
+ * @return Number of samples stored in each block (0 if no frame is available)
+ */
+uint16_t AnalogScanRead(void *blocks[]);
+
+/**
+ * @brief Build the raw to mV table of a channel.
+ * 
+ * The 4096 values of the curve fitting calibration are computed once, so every read of 
+ * this channel (single, continuous or scan) is returned in mV at the cost of a table lookup.
+ * 
+ * @note Each table takes 8kB of RAM.
+ * 
+ * @param channel Channel selected
+ * @return true if the table was built, false if there is not enough memory
+ */
+bool AnalogCalibrationInit(adc_ch_t channel);
+
+/**
+ * @brief Convert a block of raw values to mV using the channel table.
+ * 
+ * @note Does nothing if AnalogCalibrationInit() was not called for the channel.
+ * 
+ * @param channel Channel selected
+ * @param raw Raw values array
+ * @param mv Array to store values in mV (can be the same as raw)
+ * @param length Number of values to convert
+ */
+void AnalogRawToMv(adc_ch_t channel, const uint16_t *raw, uint16_t *mv, uint16_t length);
+
+/**
+ * @brief Convert every block of a lent frame (ADC_FORMAT_U16) to mV in place.
+ * 
+ * @note Lent frames are always delivered with raw values, even for calibrated channels.
+ * 
+ * @param frame Frame obtained with AnalogFrameTake()
+ */
+void AnalogFrameToMv(analog_frame_t *frame);
+
+/**
+ * @brief Lend completed frames to a task instead of storing them in the driver ring.
+ * 
+ * Each frame is split in per-channel blocks directly from the DMA buffer, so no further copy is 
+ * needed. The task is notified (xTaskNotifyGive) every time a frame is ready to be taken.
+ * 
+ * @note Must be called before AnalogStartContinuous() or AnalogScanStart(). While a task is 
+ * subscribed, AnalogInputReadContinuous() and AnalogScanRead() return no data.
+ * 
+ * @param task Task to be notified (NULL to return to the driver ring)
+ */
+void AnalogFrameSubscribe(TaskHandle_t task);
+
+/**
+ * @brief Take the oldest lent frame.
+ * 
+ * @param frame Pointer to store the frame address
+ * @return true if a frame was taken, false if none is ready
+ */
+bool AnalogFrameTake(analog_frame_t **frame);
+
+/**
+ * @brief Return a frame to the driver once it has been processed.
+ * 
+ * @note Frames not returned can't be filled again, and new conversions are lost while 
+ * every frame is lent.
+ * 
+ * @param frame Frame obtained with AnalogFrameTake()
  */
-void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
+void AnalogFrameGive(analog_frame_t *frame);
 
 /**
  * @brief Digital-to-Analog convert.
@@ -109,6 +328,141 @@ void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values);
  */
 void AnalogOutputWrite(uint8_t value);
 
+/**
+ * @brief Analog clock initialization
+ * 
+ * The analog clock is a hardware timer that, on each tick, updates the DAC and then samples 
+ * the selected input. Both paths use double buffers of block_size samples, so DAC sample i 
+ * and ADC sample i of the same block always keep the same phase relationship.
+ * 
+ * @note Uses one of the ESP32-C6 general purpose timers.
+ * 
+ * @note A zero sample_frec is ignored (the clock is left as it was).
+ * 
+ * @param config Analog clock config structure
+ */
+void AnalogClockInit(analog_clock_config_t *config);
+
+/**
+ * @brief Start analog clock
+ * 
+ */
+void AnalogClockStart(void);
+
+/**
+ * @brief Stop analog clock
+ * 
+ */
+void AnalogClockStop(void);
+
+/**
+ * @brief Return the last block acquired by the analog clock.
+ * 
+ * @note Valid until the next block end (block_size / sample_frec seconds).
+ * 
+ * @return Pointer to block_size samples (in mV if the input is calibrated)
+ */
+uint16_t* AnalogClockInputBlock(void);
+
+/**
+ * @brief Return the DAC block to be filled, it will be output after the current one.
+ * 
+ * @return Pointer to block_size values (from 0 to 255)
+ */
+uint8_t* AnalogClockOutputBlock(void);
+
+/**
+ * @brief Time of the first sample of the block returned by AnalogClockInputBlock().
+ * 
+ * @return Time in us since boot
+ */
+uint64_t AnalogClockInputTimestamp(void);
+
+/**
+ * @brief Waveform player initialization
+ * 
+ * Players are updated on each analog clock tick, so several outputs (one per SDM channel) 
+ * can be generated at the same time with different sample rates. If the analog clock was not 
+ * initialized, it is initialized at this player sample_frec.
+ * 
+ * @note The GPIO used by AnalogOutputInit() takes one of the SDM channels.
+ * 
+ * @param config Waveform player config structure
+ */
+void AnalogPlayerInit(analog_player_config_t *config);
+
+/**
+ * @brief Load a new samples buffer (stops the player)
+ * 
+ * @param player Player number
+ * @param buffer Samples buffer (values from 0 to 255)
+ * @param length Number of samples in buffer
+ */
+void AnalogPlayerLoad(analog_player_num_t player, uint8_t *buffer, uint16_t length);
+
+/**
+ * @brief Start playing from the beginning of the buffer (starts the analog clock if needed)
+ * 
+ * @param player Player number
+ * @return false if nothing is loaded, the analog clock is not initialized (or has a zero sample rate) 
+ * or the player sample_frec is above the analog clock frequency
+ */
+bool AnalogPlayerStart(analog_player_num_t player);
+
+/**
+ * @brief Stop player
+ * 
+ * @param player Player number
+ */
+void AnalogPlayerStop(analog_player_num_t player);
+
+/**
+ * @brief Player state
+ * 
+ * @param player Player number
+ * @return true if the player is playing
+ */
+bool AnalogPlayerIsActive(analog_player_num_t player);
+
+/**
+ * @brief Return the half of the buffer that is not being played (stream mode).
+ * 
+ * @param player Player number
+ * @return Pointer to length / 2 samples to be refilled
+ */
+uint8_t* AnalogPlayerRefillBlock(analog_player_num_t player);
+
+/**
+ * @brief Reset and start jitter and latency statistics.
+ * 
+ * Each acquisition event is timestamped and the deviation of its interval from the nominal 
+ * period is added to the ANALOG_HIST_JITTER histogram. Events are single reads of the selected 
+ * channel, continuous/scan frames or analog clock ticks, whichever is running. The age of each 
+ * lent frame when it is taken is added to the ANALOG_HIST_LATENCY histogram.
+ * 
+ * @note Jitter bins are centered on 0 (from -ANALOG_HIST_BINS / 2 * bin_width), latency bins 
+ * start at 0.
+ * 
+ * @param channel Channel measured in single mode
+ * @param period Nominal interval between events (in us)
+ * @param bin_width Width of each histogram bin (in us)
+ */
+void AnalogStatsStart(adc_ch_t channel, uint32_t period, uint16_t bin_width);
+
+/**
+ * @brief Stop jitter and latency statistics (collected values are kept).
+ * 
+ */
+void AnalogStatsStop(void);
+
+/**
+ * @brief Get a snapshot of a histogram and its min/max/percentiles.
+ * 
+ * @param hist ANALOG_HIST_JITTER or ANALOG_HIST_LATENCY
+ * @param stats Structure to store the statistics
+ */
+void AnalogStatsGet(analog_hist_t hist, analog_stats_t *stats);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -0,0 +1,157 @@
+#ifndef ANALOG_STATS_MCU_H
+#define ANALOG_STATS_MCU_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Analog_Stats Analog statistics
+ ** @{ */
+
+/** \brief Jitter and latency histograms of the analog acquisition.
+ *
+ * Hardware independent part of the analog_io_mcu statistics (AnalogStatsStart()): histograms,
+ * percentiles and the interval/age measures. Time is read from a function given on
+ * AnalogTimingInit() (TimerGetUs() on the board, a fake clock in host tests).
+ *
+ * @note Functions are not protected: the caller serializes them (analog_io_mcu uses a
+ * critical section, since events are added from interrupts).
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 17/10/2026 | Document creation (moved from analog_io_mcu)							|
+ *
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+/*==================[macros]=================================================*/
+#define ANALOG_HIST_BINS			64		/*!< Bins of the jitter and latency histograms */
+/*==================[typedef]================================================*/
+typedef enum analog_hist {
+	ANALOG_HIST_JITTER,		/*!< Deviation of each acquisition interval from the nominal period */
+	ANALOG_HIST_LATENCY,	/*!< Time from the end of a lent frame to AnalogFrameTake() */
+} analog_hist_t;
+
+/**
+ * @brief Jitter/latency statistics
+ *
+ */
+typedef struct {
+	uint32_t count;					/*!< Number of measures */
+	int32_t min;					/*!< Minimum measure (in us) */
+	int32_t max;					/*!< Maximum measure (in us) */
+	int32_t p50;					/*!< 50th percentile (in us, upper edge of its bin) */
+	int32_t p90;					/*!< 90th percentile (in us, upper edge of its bin) */
+	int32_t p99;					/*!< 99th percentile (in us, upper edge of its bin) */
+	int32_t first_bin;				/*!< Lower edge of bins[0] (in us) */
+	uint16_t bin_width;				/*!< Width of each bin (in us) */
+	uint32_t bins[ANALOG_HIST_BINS];/*!< Measures in each bin (out of range measures are added to the first/last bin) */
+} analog_stats_t;
+
+/**
+ * @brief Acquisition timing measures
+ *
+ */
+typedef struct {
+	analog_stats_t hist[2];			/*!< Histograms (indexed by analog_hist_t) */
+	uint64_t (*clock_p)(void);		/*!< Time source (in us) */
+	uint32_t period;				/*!< Nominal interval between acquisition events (in us) */
+	uint64_t last;					/*!< Time of the last acquisition event (0 if none since init) */
+} analog_timing_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Add a measure to a histogram.
+ *
+ * @param stats Histogram
+ * @param value Measure (in us)
+ */
+static inline void AnalogStatsAdd(analog_stats_t *stats, int32_t value){
+	int32_t bin = (value - stats->first_bin) / (int32_t)stats->bin_width;
+	if(value < stats->first_bin || bin < 0){
+		bin = 0;
+	} else if(bin >= ANALOG_HIST_BINS){
+		bin = ANALOG_HIST_BINS - 1;
+	}
+	stats->bins[bin]++;
+	if(stats->count == 0 || value < stats->min){
+		stats->min = value;
+	}
+	if(stats->count == 0 || value > stats->max){
+		stats->max = value;
+	}
+	stats->count++;
+}
+
+/**
+ * @brief Add the interval since the previous event to the jitter histogram.
+ *
+ * @param timing Timing measures
+ * @param now Time of the event (in us)
+ */
+static inline void AnalogTimingEventAt(analog_timing_t *timing, uint64_t now){
+	if(timing->last != 0){
+		AnalogStatsAdd(&timing->hist[ANALOG_HIST_JITTER], (int32_t)(now - timing->last) - (int32_t)timing->period);
+	}
+	timing->last = now;
+}
+
+/**
+ * @brief Add the interval since the previous event, timestamped now, to the jitter histogram.
+ *
+ * @param timing Timing measures
+ */
+static inline void AnalogTimingEvent(analog_timing_t *timing){
+	AnalogTimingEventAt(timing, timing->clock_p());
+}
+
+/**
+ * @brief Add the time elapsed since a frame was ready to the latency histogram.
+ *
+ * @param timing Timing measures
+ * @param ready Time when the frame was ready (in us)
+ */
+static inline void AnalogTimingLatency(analog_timing_t *timing, uint64_t ready){
+	AnalogStatsAdd(&timing->hist[ANALOG_HIST_LATENCY], (int32_t)(timing->clock_p() - ready));
+}
+
+/**
+ * @brief Reset the timing measures.
+ *
+ * @note Jitter bins are centered on 0 (from -ANALOG_HIST_BINS / 2 * bin_width), latency bins
+ * start at 0.
+ *
+ * @param timing Timing measures
+ * @param clock_p Time source (in us, must not return 0)
+ * @param period Nominal interval between events (in us)
+ * @param bin_width Width of each histogram bin (in us, 0 is taken as 1)
+ */
+void AnalogTimingInit(analog_timing_t *timing, uint64_t (*clock_p)(void), uint32_t period, uint16_t bin_width);
+
+/**
+ * @brief Percentile of a histogram (upper edge of the bin where it falls, limited to min/max).
+ *
+ * @param stats Histogram
+ * @param percent Percentile (1 to 100)
+ * @return Percentile (in us, 0 if there are no measures)
+ */
+int32_t AnalogStatsPercentile(const analog_stats_t *stats, uint8_t percent);
+
+/**
+ * @brief Fill p50, p90 and p99 of a histogram.
+ *
+ * @param stats Histogram
+ */
+void AnalogStatsSummary(analog_stats_t *stats);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
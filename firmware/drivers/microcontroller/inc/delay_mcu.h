@@ -11,8 +11,15 @@
  *
  * This driver provide functions to generate delays FreeRTOS friendly, using one timer.
  * 
+ * Short delays are kept in a deadline queue served by a single software timer (see timer_mcu), 
+ * so any number of tasks can be delayed at the same time without allocating memory.
+ * 
  * @note All delays will block the current RTOS task, with the exception of 
- * DelayUs with usec < 50.
+ * DelayUs with usec < 50, DelayNs and DelayCycles.
+ * 
+ * DelayNs and DelayCycles are busy-waits on the CPU cycle counter, intended for sub-microsecond 
+ * bit-banging. They are converted with the current CPU frequency, so they remain correct if it 
+ * changes, and the cost of the call itself (measured by DelayCyclesCalibrate()) is discounted.
  *
  * @author Albano Peñalva
  *
@@ -21,18 +28,62 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/10/2023 | Document creation		                         						|
+ * | 16/10/2026 | Reentrant delays on a persistent timer								|
+ * | 16/10/2026 | Cycle-calibrated busy-waits (DelayCycles, DelayNs)					|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include <stdint.h>
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
 /*==================[macros]=================================================*/
 
 /*==================[typedef]================================================*/
 
 /*==================[internal data declaration]==============================*/
-
+extern uint32_t delay_cycles_overhead;	/*!< CPU cycles spent by a DelayCycles(0) call */
 /*==================[internal functions declaration]=========================*/
+/**
+ * @brief Measure the overhead of DelayCycles() (called once at init by bit-banging drivers)
+ * @return None
+ */
+void DelayCyclesCalibrate(void);
+
+/**
+ * @brief Busy-wait a number of CPU cycles
+ * @param[in] cycles CPU cycles to be in delay
+ * @return None
+ */
+static inline IRAM_ATTR void DelayCycles(uint32_t cycles){
+	uint32_t start = esp_cpu_get_cycle_count();
+	cycles = (cycles > delay_cycles_overhead) ? (cycles - delay_cycles_overhead) : 0;
+	while((esp_cpu_get_cycle_count() - start) < cycles);
+}
+
+/**
+ * @brief Convert nanoseconds to CPU cycles at the current CPU frequency
+ * @param[in] nsec nanoseconds (up to 26 ms at 160 MHz)
+ * @return CPU cycles
+ */
+static inline IRAM_ATTR uint32_t DelayNsToCycles(uint32_t nsec){
+	return nsec * esp_rom_get_cpu_ticks_per_us() / 1000;
+}
+
+/**
+ * @brief Busy-wait in nanoseconds
+ * 
+ * @note Resolution is one CPU cycle, but the conversion adds a few cycles: for the tightest 
+ * timings convert once with DelayNsToCycles() and use DelayCycles().
+ * 
+ * @param[in] nsec nanoseconds to be in delay (up to 26 ms at 160 MHz)
+ * @return None
+ */
+static inline IRAM_ATTR void DelayNs(uint32_t nsec){
+	DelayCycles(DelayNsToCycles(nsec));
+}
+
 /**
  * @brief Delay in seconds
  * @param[in] sec seconds to be in delay
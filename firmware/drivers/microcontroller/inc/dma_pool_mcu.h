@@ -0,0 +1,115 @@
+#ifndef DMA_POOL_MCU_H
+#define DMA_POOL_MCU_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup DMA_Pool DMA Pool
+ ** @{ */
+
+/** \brief Fixed-block pool of DMA capable buffers for peripheral drivers.
+ *
+ * Blocks are taken from DMA_POOL_CLASSES size classes, each one a single region of internal 
+ * DMA capable memory allocated by DmaPoolInit(). Free blocks of each class are kept in a list, 
+ * so DmaPoolAlloc() and DmaPoolFree() take constant time and can be called from tasks and ISRs.
+ * 
+ * | Class	| Block size			| Blocks				|
+ * |:------:|:---------------------:|:---------------------:|
+ * | 0		| 64					| DMA_POOL_64_QTY		|
+ * | 1		| 256					| DMA_POOL_256_QTY		|
+ * | 2		| 1024					| DMA_POOL_1024_QTY		|
+ * | 3		| 4092					| DMA_POOL_4092_QTY		|
+ * 
+ * @note ESP32-C6 internal RAM is not cached, so DMA only requires word aligned buffers with a 
+ * size multiple of 4 bytes (DMA_POOL_ALIGN).
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+/*==================[macros]=================================================*/
+#define DMA_POOL_ALIGN		4		/*!< Block alignment (in bytes) */
+#define DMA_POOL_CLASSES	4		/*!< Number of block sizes */
+#ifndef DMA_POOL_64_QTY
+#define DMA_POOL_64_QTY		16		/*!< Blocks of 64 bytes */
+#endif
+#ifndef DMA_POOL_256_QTY
+#define DMA_POOL_256_QTY	8		/*!< Blocks of 256 bytes */
+#endif
+#ifndef DMA_POOL_1024_QTY
+#define DMA_POOL_1024_QTY	4		/*!< Blocks of 1024 bytes */
+#endif
+#ifndef DMA_POOL_4092_QTY
+#define DMA_POOL_4092_QTY	2		/*!< Blocks of 4092 bytes (maximum SPI DMA transfer) */
+#endif
+/*==================[typedef]================================================*/
+/**
+ * @brief Usage statistics of a size class
+ */
+typedef struct {
+	uint16_t block_size;	/*!< Bytes per block */
+	uint16_t blocks;		/*!< Blocks in the class */
+	uint16_t in_use;		/*!< Blocks currently allocated */
+	uint16_t high_water;	/*!< Maximum blocks allocated at the same time */
+	uint32_t failed;		/*!< Requests for this class that found every block (of this and bigger classes) in use */
+} dma_pool_stats_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Allocate the pool memory (only the first call has effect)
+ * 
+ * @note Must be called from a task before any allocation (drivers using the pool call it in their init).
+ * 
+ * @return true if the memory of every class could be allocated
+ */
+bool DmaPoolInit(void);
+
+/**
+ * @brief Take a block of at least size bytes
+ * 
+ * @note If every block of the smallest fitting class is in use, a block of a bigger class is returned.
+ * 
+ * @param size Bytes required
+ * @return Pointer to the block (NULL if there is no free block)
+ */
+void *DmaPoolAlloc(uint32_t size);
+
+/**
+ * @brief Return a block to the pool
+ * 
+ * @param block Pointer returned by DmaPoolAlloc() (NULL is ignored)
+ */
+void DmaPoolFree(void *block);
+
+/**
+ * @brief Usable size of a block
+ * 
+ * @param block Pointer returned by DmaPoolAlloc()
+ * @return Block size in bytes (0 if block is not from the pool)
+ */
+uint16_t DmaPoolBlockSize(const void *block);
+
+/**
+ * @brief Read usage statistics of a size class
+ * 
+ * @param size_class Class number (0 to DMA_POOL_CLASSES - 1)
+ * @param stats Pointer to struct where statistics will be stored
+ */
+void DmaPoolGetStats(uint8_t size_class, dma_pool_stats_t *stats);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
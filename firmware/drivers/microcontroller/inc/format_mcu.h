@@ -0,0 +1,106 @@
+#ifndef FORMAT_MCU_H
+#define FORMAT_MCU_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Format Format
+ ** @{ */
+
+/** \brief Number to text conversion functions.
+ *
+ * Every function writes into a buffer provided by the caller and returns the number of 
+ * characters written (the '\0' is added but not counted), so they can be used from several 
+ * tasks at the same time. Decimal conversions produce two digits per division.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * | 17/10/2026 | Base and empty CSV checks, host test against snprintf					|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+/*==================[macros]=================================================*/
+#define FORMAT_INT_SIZE		12		/*!< Buffer size for any int32_t or uint32_t in base 10 (sign and '\0' included) */
+#define FORMAT_BIN_SIZE		33		/*!< Buffer size for any uint32_t in base 2 ('\0' included) */
+#define FORMAT_FLOAT_SIZE	20		/*!< Buffer size for any FormatFloat() result with up to 6 decimals */
+#define FORMAT_CSV_EOL		"\r\n"	/*!< CSV line end */
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Convert an unsigned number to decimal text
+ * 
+ * @param val Number to be converted
+ * @param buf Buffer to store the text (FORMAT_INT_SIZE bytes)
+ * @return Number of characters
+ */
+uint8_t FormatUint32(uint32_t val, char *buf);
+
+/**
+ * @brief Convert a signed number to decimal text
+ * 
+ * @param val Number to be converted
+ * @param buf Buffer to store the text (FORMAT_INT_SIZE bytes)
+ * @return Number of characters
+ */
+uint8_t FormatInt32(int32_t val, char *buf);
+
+/**
+ * @brief Convert an unsigned number to text in any base
+ * 
+ * @param val Number to be converted
+ * @param base Base of the converted number (from 2 to 16)
+ * @param buf Buffer to store the text (FORMAT_BIN_SIZE bytes for base 2)
+ * @return Number of characters (0 and an empty string if base is out of range)
+ */
+uint8_t FormatUint32Base(uint32_t val, uint8_t base, char *buf);
+
+/**
+ * @brief Convert a fixed-point number to decimal text (e.g. 12345 with 2 decimals is "123.45")
+ * 
+ * @param val Number scaled by 10^decimals
+ * @param decimals Number of decimal digits (up to 9)
+ * @param buf Buffer to store the text (FORMAT_INT_SIZE + 1 bytes)
+ * @return Number of characters
+ */
+uint8_t FormatFixed(int32_t val, uint8_t decimals, char *buf);
+
+/**
+ * @brief Convert a float to decimal text, rounded to a number of decimals
+ * 
+ * @note Values of magnitude above 4294967295 are written as "ovf".
+ * 
+ * @param val Number to be converted
+ * @param decimals Number of decimal digits (up to 6)
+ * @param buf Buffer to store the text (FORMAT_FLOAT_SIZE bytes)
+ * @return Number of characters
+ */
+uint8_t FormatFloat(float val, uint8_t decimals, char *buf);
+
+/**
+ * @brief Convert per-channel sample blocks to CSV lines ("ch0,ch1,...\r\n" for each sample)
+ * 
+ * @param blocks Array of block_qty pointers to int16_t arrays (e.g. AnalogScanRead() blocks)
+ * @param block_qty Number of blocks (columns)
+ * @param length Samples in each block (lines)
+ * @param buf Buffer to store the text
+ * @param size Size of buf
+ * @return Number of characters (only complete lines are written, 0 if block_qty or length is 0)
+ */
+uint16_t FormatCsv(const int16_t *blocks[], uint8_t block_qty, uint16_t length, char *buf, uint16_t size);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
@@ -8,6 +8,18 @@
  ** @{ */
 
 /** \brief GPIO driver to use gpio ouputs with faster functions than gpio_mcu.
+ * 
+ * Pins are grouped in bundles of dedicated GPIOs (GPIOBundleCreate()), driven directly by 
+ * CPU instructions: every pin of a bundle is written (GPIOBundleWrite()) or sampled 
+ * (GPIOBundleRead()) at once, instead of one gpio_mcu call per pin. Bundles can be output, 
+ * input or bidirectional (open-drain).
+ * 
+ * @note ESP32-C6 has 8 dedicated output and 8 dedicated input channels, shared by every bundle.
+ * 
+ * GPIOFastInit() and GPIOFastWrite() keep working on a single output bundle.
+ * 
+ * Write and read functions are inlined in the caller: each one is a few CPU instructions on 
+ * the dedicated GPIO registers, without function calls (they can be used from IRAM code).
  * 
  * @author Albano Peñalva
  *
@@ -16,6 +28,8 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/11/2023 | Document creation		                         						|
+ * | 17/10/2026 | Handle-based input, output and bidirectional bundles					|
+ * | 17/10/2026 | Inline bundle read and write on the dedicated GPIO registers			|
  * 
  **/
 
@@ -23,28 +37,117 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "gpio_mcu.h"
+#include "driver/dedic_gpio.h"
+#include "hal/dedic_gpio_cpu_ll.h"
 /*==================[macros]=================================================*/
-
+#define GPIO_BUNDLE_PINS_MAX	8		/*!< Dedicated channels of each direction */
 /*==================[typedef]================================================*/
+/**
+ * @brief Bundle direction
+ */
+typedef enum {
+	GPIO_BUNDLE_OUTPUT,		/*!< Push-pull outputs */
+	GPIO_BUNDLE_INPUT,		/*!< Inputs */
+	GPIO_BUNDLE_INOUT		/*!< Open-drain outputs with pull-up, read back as inputs */
+} gpio_bundle_dir_t;
+
+/**
+ * @brief Bundle configuration struct
+ */
+typedef struct {
+	gpio_t *pin_list;		/*!< Pins of the bundle (first pin is bit 0) */
+	uint8_t pin_qty;		/*!< Number of pins (not more than GPIO_BUNDLE_PINS_MAX) */
+	gpio_bundle_dir_t dir;	/*!< Direction */
+} gpio_bundle_config_t;
+
+/**
+ * @brief Bundle of dedicated GPIOs (fields are only used by the inline functions)
+ */
+struct gpio_bundle {
+	dedic_gpio_bundle_handle_t handle;	/*!< Driver bundle */
+	gpio_bundle_dir_t dir;				/*!< Direction */
+	uint32_t out_mask;					/*!< Output channels of the bundle (in the CPU register) */
+	uint32_t in_mask;					/*!< Input channels of the bundle (in the CPU register) */
+	uint8_t out_offset;					/*!< First output channel */
+	uint8_t in_offset;					/*!< First input channel */
+};
+
+/**
+ * @brief Bundle handle
+ */
+typedef struct gpio_bundle *gpio_bundle_handle_t;
 
 /*==================[external data declaration]==============================*/
+extern gpio_bundle_handle_t gpio_fast_bundle;	/*!< Bundle used by GPIOFastWrite() */
 
 /*==================[external functions declaration]=========================*/
 
 /**
- * @brief 
+ * @brief Create a bundle of dedicated GPIOs.
+ * 
+ * @param config Bundle configuration
+ * @return Bundle handle (NULL if there are not enough free channels)
+ */
+gpio_bundle_handle_t GPIOBundleCreate(gpio_bundle_config_t *config);
+
+/**
+ * @brief Free a bundle and its channels.
+ * 
+ * @param bundle Bundle handle
+ */
+void GPIOBundleDelete(gpio_bundle_handle_t bundle);
+
+/**
+ * @brief Write some pins of an output or bidirectional bundle at once.
+ * 
+ * @param bundle Bundle handle
+ * @param mask Pins to write (bit 0: first pin), the others keep their state
+ * @param value New pin states
+ */
+__attribute__((always_inline))
+static inline void GPIOBundleWrite(gpio_bundle_handle_t bundle, uint32_t mask, uint32_t value){
+	dedic_gpio_cpu_ll_write_mask(bundle->out_mask & (mask << bundle->out_offset), value << bundle->out_offset);
+}
+
+/**
+ * @brief Sample every pin of an input or bidirectional bundle at once.
+ * 
+ * @param bundle Bundle handle
+ * @return Pin levels (bit 0: first pin)
+ */
+__attribute__((always_inline))
+static inline uint32_t GPIOBundleRead(gpio_bundle_handle_t bundle){
+	return (dedic_gpio_cpu_ll_read_in() & bundle->in_mask) >> bundle->in_offset;
+}
+
+/**
+ * @brief Read the last states written to an output or bidirectional bundle.
+ * 
+ * @param bundle Bundle handle
+ * @return Pin states (bit 0: first pin)
+ */
+__attribute__((always_inline))
+static inline uint32_t GPIOBundleReadOut(gpio_bundle_handle_t bundle){
+	return (dedic_gpio_cpu_ll_read_out() & bundle->out_mask) >> bundle->out_offset;
+}
+
+/**
+ * @brief Initialize a single output bundle, used by GPIOFastWrite().
  * 
- * @param pin_list 
- * @param pin_qty 
+ * @param pin_list Pins of the bundle (first pin is bit 0)
+ * @param pin_qty Number of pins (not more than GPIO_BUNDLE_PINS_MAX)
  */
 void GPIOFastInit(gpio_t *pin_list, uint8_t pin_qty);
 
 /**
- * @brief 
+ * @brief Write every pin of the bundle initialized with GPIOFastInit().
  * 
- * @param value 
+ * @param value New pin states (bit 0: first pin)
  */
-void GPIOFastWrite(uint16_t value);
+__attribute__((always_inline))
+static inline void GPIOFastWrite(uint16_t value){
+	dedic_gpio_cpu_ll_write_mask(gpio_fast_bundle->out_mask, (uint32_t)value << gpio_fast_bundle->out_offset);
+}
 
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -19,6 +19,9 @@
  * @note GPIO_12 and GPIO_13 are not recommended for use, because using them will
  * overwrite the flash and debug functionalities via USB.
  * 
+ * Several outputs can be changed at the same time with GPIOWriteMask(), using GPIO_MASK() 
+ * to build the pin mask.
+ * 
  * @author Albano Peñalva
  *
  * @section changelog
@@ -26,6 +29,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 23/10/2023 | Document creation		                         						|
+ * | 17/10/2026 | Atomic multi-pin write												|
  * 
  **/
 
@@ -33,6 +37,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 /*==================[macros]=================================================*/
+#define GPIO_MASK(pin)	(1UL << (pin))	/*!< Bit of a GPIO in the GPIOWriteMask() arguments */
 
 /*==================[typedef]================================================*/
 /**
@@ -115,6 +120,16 @@ void GPIOState(gpio_t pin, bool state);
  */
 void GPIOToggle(gpio_t pin);
 
+/**
+ * @brief Change the state of several GPIOs at once
+ * 
+ * @note Pins in mask change together, with a single output register write.
+ * 
+ * @param mask GPIOs to change (see GPIO_MASK()), the others keep their state
+ * @param values New GPIO states (bit set: high - bit clear: low)
+ */
+void GPIOWriteMask(uint32_t mask, uint32_t values);
+
 /**
  * @brief Reads GPIO state
  * 
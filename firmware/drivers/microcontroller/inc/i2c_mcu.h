@@ -14,6 +14,22 @@
  * 
  * @note ESP-EDU have 4 I2C connector in the board (J4, J5, J6 and J8), but all of them are routed to the same I2C port.
  *
+ * Each slave address gets a persistent device handle on the first transfer. Register reads 
+ * are a single write-then-read transaction with repeated start. Transfers can also be queued 
+ * (I2C_readBytesAsync(), I2C_writeBytesAsync()) and are then done by the I2C task, which calls 
+ * a function when each one ends.
+ *
+ * Optionally, a device can keep shadow registers (I2C_cacheEnable()): register reads are served 
+ * from RAM once the value is known, writes go through to the device and update the shadow, 
+ * and bit writes that don't change the register are skipped. Status and data registers must 
+ * be excluded with I2C_cacheSetVolatile(), and registers changed by the device itself (e.g. 
+ * self-clearing reset bits) invalidated with I2C_cacheInvalidate().
+ *
+ * Several queued transactions can be submitted as a batch (I2C_submit()): they are queued 
+ * together and the I2C task runs them back to back, without synchronous transfers in between. Each device can use its own clock, up to 
+ * Fast-mode Plus (I2C_setClock()), and counts transactions, bytes, NACKs, timeouts, other 
+ * errors and bus occupancy (I2C_getStats()).
+ *
  * @author Juan Ignacio Cerrudo
  * 
  * @section changelog
@@ -21,6 +37,13 @@
  * |   Date	    | Description                                    |
  * |:----------:|:-----------------------------------------------|
  * | 30/01/2024 | Document creation		                         |
+ * | 16/10/2026 | Ported to i2c_master driver, async transfers	 |
+ * | 16/10/2026 | Shadow register cache							 |
+ * | 17/10/2026 | I2C scheduler, statistics and Fm+ clock		 |
+ * | 17/10/2026 | Safe clock change and init, error counter		 |
+ * | 17/10/2026 | Async reads longer than 127 bytes report success|
+ * | 17/10/2026 | Cache and read-modify-write atomic between tasks|
+ * | 17/10/2026 | Atomic batches, stats queries don't add devices |
  *
  */
 
@@ -28,24 +51,64 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_log.h"
-#include "driver/i2c.h"
+#include "driver/i2c_master.h"
 #include "gpio_mcu.h"
 /*==================[macros]=================================================*/
 
 /*==================[typedef]================================================*/
+/**
+ * @brief Function called when a queued transfer ends
+ * 
+ * @param param Pointer given when the transfer was queued
+ * @param success true if the slave acknowledged the whole transfer
+ */
+typedef void (*i2c_callback_t)(void *param, bool success);
+
+/**
+ * @brief Transaction done by the I2C task
+ */
+typedef struct {
+	uint8_t devAddr;			/*!< I2C slave device address */
+	uint8_t regAddr;			/*!< First register */
+	uint8_t length;				/*!< Number of bytes */
+	bool read;					/*!< true: read from the device, false: write to the device */
+	uint8_t *data;				/*!< Data buffer, must remain valid until func_p is called */
+	i2c_callback_t func_p;		/*!< Function called when the transaction ends (NULL if not required) */
+	void *param_p;				/*!< Parameter of func_p */
+} i2c_transaction_t;
+
+/**
+ * @brief Bus usage of a device since the last I2C_resetStats()
+ */
+typedef struct {
+	uint32_t transactions;		/*!< Transactions done */
+	uint32_t bytes;				/*!< Data bytes transferred */
+	uint32_t nacks;				/*!< Transactions not acknowledged by the device */
+	uint32_t timeouts;			/*!< Transactions timed out */
+	uint32_t errors;			/*!< Transactions failed for any other reason */
+	uint64_t busy_us;			/*!< Time spent on the bus (in us) */
+	uint8_t occupancy;			/*!< busy_us as a percentage of the elapsed time */
+} i2c_stats_t;
+
 #define I2C_MASTER_SCL_IO           GPIO_7      /*!< GPIO number used for I2C master clock */
 #define I2C_MASTER_SDA_IO           GPIO_6      /*!< GPIO number used for I2C master data  */
 #define I2C_MASTER_NUM              0           /*!< I2C master i2c port number, the number of i2c peripheral interfaces available will depend on the chip */
 #define I2C_MASTER_FREQ_HZ          400000      /*!< I2C master clock frequency */
+#define I2C_MASTER_FREQ_MAX         1000000     /*!< Fast-mode Plus, needs stronger pull-ups than the board ones */
 #define I2C_MASTER_TX_BUF_DISABLE   0           /*!< I2C master doesn't need buffer */
 #define I2C_MASTER_RX_BUF_DISABLE   0           /*!< I2C master doesn't need buffer */
 #define I2C_MASTER_TIMEOUT_MS       1000
+#define I2C_DEVICES_MAX             8           /*!< Maximum number of slave addresses in use */
+#define I2C_QUEUE_SIZE              8           /*!< Maximum number of queued transfers */
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
 
 /** @fn I2C_initialize( uint32_t clockRateHz )
  * @brief Initialize I2C0
+ * @note Called on the first transfer if needed. On failure nothing is left running and it can be called again.
+ * @param clockRateHz SCL frequency of the devices (limited to I2C_MASTER_FREQ_MAX)
+ * @return true if the bus is ready
  */
 bool I2C_initialize( uint32_t clockRateHz );
 
@@ -105,7 +168,7 @@ int8_t I2C_readWord(uint8_t devAddr, uint8_t regAddr, uint16_t *data, uint16_t t
  * @param length Number of bytes to read
  * @param data Buffer to store read data in
  * @param timeout Optional read timeout in milliseconds (0 to disable, leave off to use default class value in I2C_readTimeout)
- * @return I2C_TransferReturn_TypeDef
+ * @return Number of bytes read, 0 on error (lengths above 127 come back negative: check != 0)
  */
 int8_t I2C_readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout);
 
@@ -158,6 +221,104 @@ bool I2C_writeWord(uint8_t devAddr, uint8_t regAddr, uint16_t data);
  */
 bool I2C_writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data);
 
+/** @fn I2C_readBytesAsync(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, i2c_callback_t func_p, void *param_p)
+ * @brief Queue a read of multiple bytes from an 8-bit device register.
+ * @note data must remain valid until func_p is called.
+ * @param devAddr I2C slave device address
+ * @param regAddr First register regAddr to read from
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ * @param func_p Function called (from the I2C task) when the transfer ends (NULL if not required)
+ * @param param_p Parameter of func_p
+ * @return true if the transfer was queued
+ */
+bool I2C_readBytesAsync(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, i2c_callback_t func_p, void *param_p);
+
+/** @fn I2C_writeBytesAsync(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, i2c_callback_t func_p, void *param_p)
+ * @brief Queue a write of multiple bytes to device.
+ * @note data must remain valid until func_p is called.
+ * @param devAddr I2C slave device address
+ * @param regAddr Register address to write to
+ * @param length Number of bytes to write
+ * @param data Array of bytes to write
+ * @param func_p Function called (from the I2C task) when the transfer ends (NULL if not required)
+ * @param param_p Parameter of func_p
+ * @return true if the transfer was queued
+ */
+bool I2C_writeBytesAsync(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, i2c_callback_t func_p, void *param_p);
+
+/** @fn I2C_submit(const i2c_transaction_t *transactions, uint8_t qty)
+ * @brief Queue a batch of transactions, done back to back by the I2C task.
+ * @note Either every transaction is queued or none is.
+ * @note The I2C task holds the bus for up to I2C_QUEUE_SIZE queued transactions: synchronous 
+ * calls from other tasks wait until they are done. Callbacks run holding the bus, so they can 
+ * use the synchronous functions but must not wait for other tasks using I2C.
+ * @param transactions Array of transactions (copied, only data must remain valid)
+ * @param qty Number of transactions (not more than I2C_QUEUE_SIZE)
+ * @return true if the batch was queued
+ */
+bool I2C_submit(const i2c_transaction_t *transactions, uint8_t qty);
+
+/** @fn I2C_setClock(uint8_t devAddr, uint32_t clockRateHz)
+ * @brief Change the SCL frequency used with a device.
+ * @note Waits for the transfer in progress. If the device can't be added again with the new 
+ * clock, the previous one is restored; if that fails too, transfers with the device fail 
+ * until a later I2C_setClock() succeeds.
+ * @param devAddr I2C slave device address
+ * @param clockRateHz SCL frequency (limited to I2C_MASTER_FREQ_MAX)
+ * @return Status of operation (true = success)
+ */
+bool I2C_setClock(uint8_t devAddr, uint32_t clockRateHz);
+
+/** @fn I2C_getStats(uint8_t devAddr, i2c_stats_t *stats)
+ * @brief Read the bus usage of a device.
+ * @param devAddr I2C slave device address
+ * @param stats Container for the statistics
+ * @return Status of operation (false if the device was never used)
+ */
+bool I2C_getStats(uint8_t devAddr, i2c_stats_t *stats);
+
+/** @fn I2C_resetStats(void)
+ * @brief Clear the statistics of every device.
+ */
+void I2C_resetStats(void);
+
+/** @fn I2C_cacheEnable(uint8_t devAddr)
+ * @brief Keep shadow registers of a device (256 bytes of RAM).
+ * @param devAddr I2C slave device address
+ * @return Status of operation (true = success)
+ */
+bool I2C_cacheEnable(uint8_t devAddr);
+
+/** @fn I2C_cacheEnabled(uint8_t devAddr)
+ * @brief Check if a device keeps shadow registers.
+ * @param devAddr I2C slave device address
+ * @return true if the cache is enabled
+ */
+bool I2C_cacheEnabled(uint8_t devAddr);
+
+/** @fn I2C_cacheSetVolatile(uint8_t devAddr, uint8_t regAddr, uint8_t length)
+ * @brief Exclude registers from the cache (always read from the device).
+ * @param devAddr I2C slave device address
+ * @param regAddr First register
+ * @param length Number of registers
+ */
+void I2C_cacheSetVolatile(uint8_t devAddr, uint8_t regAddr, uint8_t length);
+
+/** @fn I2C_cacheInvalidate(uint8_t devAddr, uint8_t regAddr, uint8_t length)
+ * @brief Discard shadow registers, so the next read is done on the device.
+ * @param devAddr I2C slave device address
+ * @param regAddr First register
+ * @param length Number of registers
+ */
+void I2C_cacheInvalidate(uint8_t devAddr, uint8_t regAddr, uint8_t length);
+
+/** @fn I2C_cacheInvalidateAll(uint8_t devAddr)
+ * @brief Discard every shadow register of a device (e.g. after a device reset).
+ * @param devAddr I2C slave device address
+ */
+void I2C_cacheInvalidateAll(uint8_t devAddr);
+
 /** @fn I2C_SelectRegister(uint8_t dev, uint8_t reg)
  * @brief Select a register
  * @param devAddr I2C slave device address
@@ -14,6 +14,17 @@
  * 
  * @note MISO: GPIO_22, MOSI: GPIO_21, SCLK: GPIO_20, CS1: GPIO_19, CS2: GPIO_18, CS3: GPIO_9
  * 
+ * Each device is added to the bus once and keeps its handle until SpiDeInit(). Besides the 
+ * blocking functions, up to SPI_QUEUE_SIZE transactions per device can be queued with 
+ * SpiQueueTransfer(), so the next buffer can be prepared while DMA sends the current one. 
+ * Blocking functions wait for the queued transactions of the device before sending.
+ * 
+ * Devices share the bus in the order their transactions arrive. A device can acquire the 
+ * bus (SpiAcquireBus()) to send a sequence (e.g. command + data) without other devices 
+ * transactions in between. Small writes can be merged with SpiWriteBatched() and are sent 
+ * as one DMA transaction when the batch is full, on SpiFlush() or before any other 
+ * transfer of the same device.
+ * 
  * @author Albano Peñalva
  *
  * @section changelog
@@ -21,12 +32,19 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 09/02/2024 | Document creation		                         						|
+ * | 16/10/2026 | Persistent device handles and queued transactions						|
+ * | 16/10/2026 | Bus acquisition, batched small writes and bus statistics				|
+ * | 16/10/2026 | Batch buffers taken from the DMA pool									|
+ * | 17/10/2026 | SpiBusInitialized() to check pins shared with other drivers			|
  * 
  **/
 /*==================[inclusions]=============================================*/
 #include <stdbool.h>
 #include <stdint.h>
 /*==================[macros]=================================================*/
+#define SPI_QUEUE_SIZE	8		/*!< Maximum number of queued transactions per device */
+#define SPI_WAIT_FOREVER	0xFFFFFFFF	/*!< Timeout value to wait without limit */
+#define SPI_BATCH_SIZE	256		/*!< Bytes merged by SpiWriteBatched() before sending */
 
 /*==================[typedef]================================================*/
 
@@ -69,6 +87,16 @@ typedef struct{
 	void *func_p;					/*!< Pointer to callback function for transaction end */
 	void *param_p;					/*!< Pointer to callback parameter */
 } spi_mcu_config_t;
+
+/**
+ * @brief SPI usage statistics (since last SpiResetStats())
+ */
+typedef struct{
+	uint32_t transactions;			/*!< Transactions finished */
+	uint64_t bytes;					/*!< Bytes transferred */
+	uint32_t bytes_per_s;			/*!< Average throughput */
+	uint8_t busy;					/*!< Bus time used (in %) */
+} spi_stats_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -108,9 +136,115 @@ void SpiWrite(spi_dev_t device, uint8_t * tx_buffer, uint32_t tx_buffer_size);
  */
 void SpiReadWrite(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size);
 
+/**
+ * @brief Queue a transaction and return without waiting for it
+ * 
+ * @note Buffers must be DMA capable (internal RAM) and must not be modified until the transaction 
+ * is returned by SpiWaitTransfer(). If SPI_QUEUE_SIZE transactions are in flight, waits for the 
+ * oldest one.
+ * 
+ * @param device SPI device
+ * @param tx_buffer pointer to buffer where data to write is stored (NULL to send zeros)
+ * @param rx_buffer pointer to buffer where data read is stored (NULL to discard it)
+ * @param buffer_size numbers of bytes to read or write
+ * @return true if the transaction was queued
+ */
+bool SpiQueueTransfer(spi_dev_t device, const uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size);
+
+/**
+ * @brief Wait for the oldest queued transaction of a device to finish
+ * 
+ * @param device SPI device
+ * @param timeout Maximum wait (in ms, SPI_WAIT_FOREVER to wait without limit)
+ * @return true if a transaction finished (or none was queued), false on timeout
+ */
+bool SpiWaitTransfer(spi_dev_t device, uint32_t timeout);
+
+/**
+ * @brief Wait for every queued transaction of a device to finish
+ * 
+ * @param device SPI device
+ */
+void SpiWaitAll(spi_dev_t device);
+
+/**
+ * @brief Number of queued transactions of a device not yet finished
+ * 
+ * @param device SPI device
+ * @return uint8_t 
+ */
+uint8_t SpiPending(spi_dev_t device);
+
+/**
+ * @brief Add data to the device batch, sending it only when the batch is full
+ * 
+ * @note CS is kept active for the whole batch, so merged writes must be valid as a single 
+ * transfer for the device.
+ * 
+ * @param device SPI device
+ * @param tx_buffer pointer to buffer where data to write is stored (copied to the batch)
+ * @param tx_buffer_size numbers of bytes to write
+ */
+void SpiWriteBatched(spi_dev_t device, const uint8_t * tx_buffer, uint32_t tx_buffer_size);
+
+/**
+ * @brief Send the data waiting in the device batch
+ * 
+ * @param device SPI device
+ */
+void SpiFlush(spi_dev_t device);
+
+/**
+ * @brief Reserve the bus for a device: transactions of other devices wait until SpiReleaseBus()
+ * 
+ * @param device SPI device
+ * @param timeout Maximum wait (in ms, SPI_WAIT_FOREVER to wait without limit)
+ * @return true if the bus was acquired
+ */
+bool SpiAcquireBus(spi_dev_t device, uint32_t timeout);
+
+/**
+ * @brief Send pending data of the device and free the bus
+ * 
+ * @param device SPI device
+ */
+void SpiReleaseBus(spi_dev_t device);
+
+/**
+ * @brief Read usage statistics of a device
+ * 
+ * @param device SPI device
+ * @param stats Pointer to struct where statistics will be stored
+ */
+void SpiGetStats(spi_dev_t device, spi_stats_t *stats);
+
+/**
+ * @brief Read usage statistics of the whole bus
+ * 
+ * @param stats Pointer to struct where statistics will be stored
+ */
+void SpiGetBusStats(spi_stats_t *stats);
+
+/**
+ * @brief Clear usage statistics of every device
+ */
+void SpiResetStats(void);
+
+/**
+ * @brief Check if the SPI bus pins are taken
+ * 
+ * @note The bus is initialized on the first SpiInit() and keeps its pins (MISO: GPIO_22, ...) 
+ * after SpiDeInit().
+ * 
+ * @return true if SpiInit() was called
+ */
+bool SpiBusInitialized(void);
+
 /**
  * @brief De-Initialize SPI module with the corresponding configuration
  * 
+ * @note Waits for queued transactions and removes the device from the bus.
+ * 
  * @param device SPI device 
  * @return uint8_t 
  */
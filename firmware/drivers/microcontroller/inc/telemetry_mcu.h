@@ -0,0 +1,149 @@
+#ifndef TELEMETRY_MCU_H
+#define TELEMETRY_MCU_H
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Drivers_Microcontroller Drivers microcontroller
+ ** @{ */
+/** \addtogroup Telemetry Telemetry
+ ** @{ */
+
+/** \brief Binary framed telemetry over UART for the ESP-EDU Board.
+ *
+ * Samples of up to TELEMETRY_CH_MAX channels are packed as int16_t and sent in frames of 
+ * `batch` samples per channel. Each frame is:
+ * 
+ * | Field 		| Size		| Description												|
+ * |:----------:|:---------:|:----------------------------------------------------------|
+ * | sequence	| 2			| Frame number (little endian), gaps indicate lost frames	|
+ * | channels	| 1			| Number of channels										|
+ * | length		| 2			| Samples per channel (little endian)						|
+ * | payload	| 2 * channels * length | int16_t samples (little endian), one block per channel |
+ * | crc		| 2			| CRC-16/CCITT-FALSE of the previous fields (little endian)	|
+ * 
+ * and it is COBS encoded and delimited by 0x00 bytes, so the receiver can resynchronize after 
+ * any lost or corrupted byte. The codec functions (TelemetryCrc16(), TelemetryCobsEncode(), 
+ * TelemetryCobsDecode() and TelemetryDecode()) are plain C and can be built on the PC side.
+ * 
+ * @note Frames are queued whole with UartSendFrameAsync(), so acquisition never blocks: if the 
+ * UART can't keep up, frames are dropped (see TelemetryDropped()) and never sent truncated.
+ *
+ * @author Albano Peñalva
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * | 17/10/2026 | Frames queued whole or dropped, host loopback test					|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart_mcu.h"
+/*==================[macros]=================================================*/
+#define TELEMETRY_CH_MAX		8		/*!< Maximum number of channels */
+#define TELEMETRY_PAYLOAD_MAX	512		/*!< Maximum payload bytes (2 * channels * batch) */
+#define TELEMETRY_HEADER_SIZE	5		/*!< Sequence, channels and length bytes */
+#define TELEMETRY_CRC_SIZE		2		/*!< CRC bytes */
+#define TELEMETRY_FRAME_MAX		(TELEMETRY_HEADER_SIZE + TELEMETRY_PAYLOAD_MAX + TELEMETRY_CRC_SIZE)	/*!< Maximum frame bytes (before COBS) */
+#define TELEMETRY_COBS_MAX(n)	((n) + ((n) / 254) + 1)	/*!< Maximum COBS encoded size of n bytes */
+/*==================[typedef]================================================*/
+/**
+ * @brief Telemetry config structure
+ */
+typedef struct {
+	uart_mcu_port_t port;	/*!< Port used (initialized with UartInit()) */
+	uint8_t channel_qty;	/*!< Number of channels (up to TELEMETRY_CH_MAX) */
+	uint16_t batch;			/*!< Samples per channel in each frame (2 * channel_qty * batch up to TELEMETRY_PAYLOAD_MAX) */
+} telemetry_config_t;
+
+/**
+ * @brief Decoded telemetry frame
+ */
+typedef struct {
+	uint16_t sequence;		/*!< Frame number */
+	uint8_t channel_qty;	/*!< Number of channels */
+	uint16_t length;		/*!< Samples per channel */
+	const uint8_t *payload;	/*!< channel_qty blocks of length int16_t samples (little endian) */
+} telemetry_frame_t;
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Telemetry initialization
+ * 
+ * @param config Telemetry config structure
+ */
+void TelemetryInit(telemetry_config_t *config);
+
+/**
+ * @brief Add one sample of every channel, the frame is sent when batch samples are stored
+ * 
+ * @param samples Array of channel_qty samples
+ * @return false if a complete frame was dropped because the UART was busy
+ */
+bool TelemetryPush(const int16_t *samples);
+
+/**
+ * @brief Send per-channel blocks (e.g. from AnalogScanRead() or a lent frame) in one frame
+ * 
+ * @param blocks Array of channel_qty pointers to int16_t arrays
+ * @param length Samples in each block (2 * channel_qty * length up to TELEMETRY_PAYLOAD_MAX)
+ * @return false if the frame was dropped because the UART was busy
+ */
+bool TelemetrySendBlocks(const int16_t *blocks[], uint16_t length);
+
+/**
+ * @brief Number of frames dropped since TelemetryInit()
+ * 
+ * @return Dropped frames
+ */
+uint32_t TelemetryDropped(void);
+
+/**
+ * @brief CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF)
+ * 
+ * @param data Data array
+ * @param length Bytes in data
+ * @return CRC
+ */
+uint16_t TelemetryCrc16(const uint8_t *data, uint16_t length);
+
+/**
+ * @brief COBS encode a buffer (the 0x00 delimiter is not added)
+ * 
+ * @param src Data to encode
+ * @param length Bytes in src
+ * @param dst Encoded data (TELEMETRY_COBS_MAX(length) bytes)
+ * @return Bytes stored in dst
+ */
+uint16_t TelemetryCobsEncode(const uint8_t *src, uint16_t length, uint8_t *dst);
+
+/**
+ * @brief COBS decode a buffer (without the 0x00 delimiter)
+ * 
+ * @param src Encoded data
+ * @param length Bytes in src
+ * @param dst Decoded data (length bytes, can be the same as src)
+ * @return Bytes stored in dst (0 if src is not valid COBS)
+ */
+uint16_t TelemetryCobsDecode(const uint8_t *src, uint16_t length, uint8_t *dst);
+
+/**
+ * @brief Decode a received frame (bytes between two 0x00 delimiters)
+ * 
+ * @param src Received bytes, decoded in place
+ * @param length Bytes in src
+ * @param frame Structure to store the frame fields (payload points into src)
+ * @return true if the frame is valid (COBS, length and CRC)
+ */
+bool TelemetryDecode(uint8_t *src, uint16_t length, telemetry_frame_t *frame);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif
+
+/*==================[end of file]============================================*/
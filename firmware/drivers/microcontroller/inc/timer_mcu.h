@@ -9,6 +9,19 @@
  ** @{ */
 
 /** \brief Timer driver for the ESP-EDU Board.
+ * 
+ * Every timer of this driver is a software timer multiplexed on a single free-running hardware 
+ * timer (1us resolution). Armed timers are kept in a min-heap ordered by deadline, and the 
+ * hardware alarm is always set to the nearest one, so any number of periodic and one-shot 
+ * timers can run with O(log n) scheduling.
+ * 
+ * @note Callbacks are called from ISR, in deadline order.
+ * 
+ * @note The timer is re-armed from its ISR, so projects must enable 
+ * CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM (set in every project sdkconfig).
+ * 
+ * The driver also provides the common time base of the firmware: a monotonic 64 bit timestamp 
+ * in us (TimerGetUs()) or CPU cycles (TimerGetCycles()), with conversion helpers.
  * 
  * @author Albano Peñalva
  *
@@ -17,11 +30,18 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 20/10/2023 | Document creation		                         						|
+ * | 16/10/2026 | Handle-based software timers on a single hardware timer				|
+ * | 16/10/2026 | 64 bit timestamps (us and CPU cycles)									|
+ * | 17/10/2026 | Hardware timer start checked, thread-safe TimerCreate()				|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include <stdbool.h>
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
 /*==================[macros]=================================================*/
 
 /*==================[typedef]================================================*/
@@ -42,14 +62,102 @@ typedef struct {
 	void *func_p;			/*!< Pointer to callback function to call periodically */
 	void *param_p;			/*!< Pointer to callback function parameter */
 } timer_config_t;
+
+/**
+ * @brief Software timer configuration struct
+ */
+typedef struct {
+	uint32_t period;		/*!< Period (in us) */
+	bool one_shot;			/*!< true: callback is called once, period us after TimerArm() */
+	void *func_p;			/*!< Pointer to callback function (called from ISR) */
+	void *param_p;			/*!< Pointer to callback function parameter */
+} timer_handle_config_t;
+
+/**
+ * @brief Software timer handle
+ */
+typedef struct soft_timer *timer_handle_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
+/**
+ * @brief Time since boot.
+ * 
+ * Monotonic and free-running (never wraps in practice), cheap enough to be called from ISR.
+ * 
+ * @return Time in us
+ */
+static inline uint64_t TimerGetUs(void){
+	return esp_timer_get_time();
+}
+
+/**
+ * @brief Raw CPU cycle counter (32 bits, wraps every 2^32 cycles).
+ * 
+ * @return CPU cycles
+ */
+static inline uint32_t TimerGetCycles32(void){
+	return esp_cpu_get_cycle_count();
+}
+
+/**
+ * @brief Convert CPU cycles to us (at the current CPU frequency)
+ * 
+ * @param cycles CPU cycles
+ * @return Time in us
+ */
+static inline uint64_t TimerCyclesToUs(uint64_t cycles){
+	return cycles / esp_rom_get_cpu_ticks_per_us();
+}
+
+/**
+ * @brief Convert CPU cycles to ns (at the current CPU frequency)
+ * 
+ * @param cycles CPU cycles
+ * @return Time in ns
+ */
+static inline uint64_t TimerCyclesToNs(uint64_t cycles){
+	return cycles * 1000 / esp_rom_get_cpu_ticks_per_us();
+}
+
+/**
+ * @brief Convert us to CPU cycles (at the current CPU frequency)
+ * 
+ * @param us Time in us
+ * @return CPU cycles
+ */
+static inline uint64_t TimerUsToCycles(uint64_t us){
+	return us * esp_rom_get_cpu_ticks_per_us();
+}
+
+/**
+ * @brief Start extending the CPU cycle counter to 64 bits.
+ * 
+ * Creates a software timer that reads the counter at least once every wrap period.
+ * 
+ * @note Without it, TimerGetCycles() is only valid for intervals shorter than a wrap period 
+ * (about 26 s at 160 MHz).
+ */
+void TimerTimestampInit(void);
+
+/**
+ * @brief CPU cycles since boot (64 bits).
+ * 
+ * The low 32 bits are the CPU cycle counter (esp_cpu_get_cycle_count()), which runs from boot. 
+ * The high 32 bits count the counter wraps seen by the calls to this function, so they are 
+ * only correct if it is called at least once per wrap period (see TimerTimestampInit()).
+ * 
+ * @return CPU cycles
+ */
+uint64_t TimerGetCycles(void);
+
 /**
  * @brief Timer initialization
  * 
  * @note Timer are stopped after init
  * 
+ * @note With a zero period the timer is not created, and the other functions of this timer do nothing
+ * 
  * @param timer_ini Pointer to timer configuration
  */
 void TimerInit(timer_config_t *timer_ini);
@@ -66,6 +174,8 @@ void TimerStart(timer_mcu_t timer);
  * 
  * The returned value is counted from the last call to TimerInit(), TimerStart() or the last timer interrupt.
  * 
+ * @note It is always lower than the timer period, use TimerGetUs() for timestamps.
+ * 
  * @param timer Timer number
  * @return The current value of the timer in us
  */
@@ -98,6 +208,74 @@ void TimerReset(timer_mcu_t timer);
  */
 void TimerUpdatePeriod(timer_mcu_t timer, uint32_t period);
 
+/**
+ * @brief Create a software timer
+ * 
+ * @note Timers are disarmed after creation
+ * 
+ * @param config Pointer to timer configuration
+ * @return Timer handle (NULL if there is not enough memory, the hardware timer could not be 
+ * started or a periodic timer has a zero period)
+ */
+timer_handle_t TimerCreate(timer_handle_config_t *config);
+
+/**
+ * @brief Disarm and delete a software timer
+ * 
+ * @param timer Timer handle
+ */
+void TimerDelete(timer_handle_t timer);
+
+/**
+ * @brief Arm a software timer, first callback will be called period us from now
+ * 
+ * @note Can be called from ISR (e.g. inside a timer callback)
+ * 
+ * @param timer Timer handle
+ */
+void TimerArm(timer_handle_t timer);
+
+/**
+ * @brief Disarm a software timer
+ * 
+ * @note Can be called from ISR (e.g. inside a timer callback)
+ * 
+ * @param timer Timer handle
+ */
+void TimerDisarm(timer_handle_t timer);
+
+/**
+ * @brief Update the period of a software timer
+ * 
+ * If the timer is armed, the next deadline is moved to period us after the last one.
+ * 
+ * @note A zero period is ignored for periodic timers.
+ * 
+ * @param timer Timer handle
+ * @param period Period (in us)
+ */
+void TimerSetPeriod(timer_handle_t timer, uint32_t period);
+
+/**
+ * @brief Software timer state
+ * 
+ * @param timer Timer handle
+ * @return true if the timer is armed
+ */
+bool TimerIsArmed(timer_handle_t timer);
+
+/**
+ * @brief Number of periods missed by a periodic timer since it was created
+ * 
+ * A period is missed when its deadline has already passed by the time the previous callback 
+ * returns (e.g. long callbacks or interrupts disabled). Missed callbacks are skipped, so the 
+ * timer keeps its phase.
+ * 
+ * @param timer Timer handle
+ * @return Overrun count
+ */
+uint32_t TimerOverruns(timer_handle_t timer);
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
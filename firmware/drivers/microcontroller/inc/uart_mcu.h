@@ -9,6 +9,20 @@
  ** @{ */
 
 /** \brief UART driver for the ESP-EDU Board.
+ * 
+ * Data sent is copied to a transmission ring buffer and moved to the UART FIFO by the driver 
+ * interrupt, so send functions only block while the ring is full. UartSendBufferAsync() never 
+ * blocks: it copies data to a separate queue (as big as the ring) that a transmission task 
+ * moves to the driver.
+ * 
+ * UART_CONNECTOR supports baud rates up to 5 Mbaud. Above 1 Mbaud enable RTS/CTS flow control 
+ * (RTS: GPIO_23, CTS: GPIO_22) and bigger reception rings, and check UartGetStats() for 
+ * FIFO overflows.
+ * 
+ * @warning RTS/CTS pins are shared with other drivers: GPIO_22 is SPI MISO, LCD BCD3 
+ * (lcditse0803) and L293 EN_1_2, GPIO_23 is LCD BCD4. Flow control is not enabled if the 
+ * SPI bus was initialized (SpiBusInitialized()), and neither the LCD nor the L293 can be used 
+ * with it.
  * 
  * @author Albano Peñalva
  *
@@ -17,13 +31,24 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 02/07/2024 | Document creation		                         						|
+ * | 16/10/2026 | Buffered and non-blocking transmission								|
+ * | 16/10/2026 | UartItoa implemented over format_mcu									|
+ * | 16/10/2026 | Line mode with pattern detection and command dispatcher				|
+ * | 16/10/2026 | Ring sizes, flow control, RX thresholds, stats and loopback benchmark	|
+ * | 17/10/2026 | Asynchronous transmission queue and task								|
+ * | 17/10/2026 | RX full threshold limited to the FIFO, benchmark is the only reader	|
+ * | 17/10/2026 | Asynchronous transmission done callback, UartTxPending() upper bound	|
+ * | 17/10/2026 | Line mode takes the ring, flow control, RX and loopback settings		|
+ * | 17/10/2026 | Flow control pin conflicts documented, refused with SPI initialized	|
  * 
  **/
 
 /*==================[inclusions]=============================================*/
 #include "stdint.h"
+#include <stdbool.h>
 /*==================[macros]=================================================*/
 #define UART_NO_INT	0		/*!< Flag used when no reading interruption is required */
+#define UART_LINE_SIZE	128		/*!< Maximum line length in line mode (longer lines are discarded) */
 /*==================[typedef]================================================*/
 /**
  * @brief List of UART ports available in ESP-EDU
@@ -40,7 +65,59 @@ typedef struct {
 	uint32_t baud_rate;		/*!< baudrate (bits per second) */
 	void *func_p;			/*!< Pointer to callback function to call when receiving data (= UART_NO_INT if not requiered)*/
 	void *param_p;			/*!< Pointer to callback function parameters */
+	uint16_t rx_buffer_size;	/*!< Reception ring buffer size in bytes (0: default 256, must be above 128) */
+	uint16_t tx_buffer_size;	/*!< Transmission ring buffer size in bytes (0: default 2048, must be above 128) */
+	bool flow_ctrl;			/*!< Enable RTS/CTS hardware flow control (UART_CONNECTOR only, RTS: GPIO_23, CTS: GPIO_22, shared with SPI, LCD and L293: ignored if the SPI bus is initialized) */
+	uint8_t rx_full_thresh;	/*!< Bytes in RX FIFO that wake up the driver (0: driver default, limited to 127) */
+	uint8_t rx_timeout;		/*!< RX idle time (in symbols) that wakes up the driver (0: driver default) */
+	bool loopback;			/*!< Internally connect TX to RX */
 } serial_config_t;
+/**
+ * @brief Command of a line mode dispatch table
+ */
+typedef struct {
+	const char *name;					/*!< Command name (first word of the line) */
+	void (*func_p)(char *args, void *param);	/*!< Function called with the rest of the line (after the first space) */
+	void *param_p;						/*!< Pointer to callback function parameters */
+} uart_command_t;
+/**
+ * @brief Line mode configuration struct
+ */
+typedef struct {
+	uart_mcu_port_t port;				/*!< port */
+	uint32_t baud_rate;					/*!< baudrate (bits per second) */
+	char delimiter;						/*!< Line end character (e.g. '\n'), detected by hardware */
+	const uart_command_t *commands;		/*!< Dispatch table */
+	uint8_t command_qty;				/*!< Number of commands in the dispatch table */
+	void (*func_p)(char *line, void *param);	/*!< Function called with lines not matching any command (NULL to discard them) */
+	void *param_p;						/*!< Pointer to callback function parameters */
+	uint16_t rx_buffer_size;			/*!< Reception ring buffer size in bytes (as in serial_config_t) */
+	uint16_t tx_buffer_size;			/*!< Transmission ring buffer size in bytes (as in serial_config_t) */
+	bool flow_ctrl;						/*!< Enable RTS/CTS hardware flow control (as in serial_config_t) */
+	uint8_t rx_full_thresh;				/*!< Bytes in RX FIFO that wake up the driver (as in serial_config_t) */
+	uint8_t rx_timeout;					/*!< RX idle time (in symbols) that wakes up the driver (as in serial_config_t) */
+	bool loopback;						/*!< Internally connect TX to RX */
+} uart_line_config_t;
+/**
+ * @brief UART event counters
+ */
+typedef struct {
+	uint32_t rx_bytes;		/*!< Bytes received */
+	uint32_t fifo_ovf;		/*!< Hardware FIFO overflows (data lost) */
+	uint32_t buffer_full;	/*!< Reception ring buffer overflows (data lost) */
+	uint32_t frame_err;		/*!< Frame errors */
+	uint32_t parity_err;	/*!< Parity errors */
+} uart_stats_t;
+/**
+ * @brief Loopback benchmark results
+ */
+typedef struct {
+	uint32_t bytes;			/*!< Bytes received back */
+	uint32_t errors;		/*!< Bytes received out of sequence */
+	uint32_t bytes_per_s;	/*!< Sustained throughput */
+	uint32_t fifo_ovf;		/*!< Hardware FIFO overflows during the benchmark */
+	uint8_t cpu_load;		/*!< CPU time (in %) spent by the calling task in driver calls */
+} uart_bench_t;
 /*==================[external data declaration]==============================*/
 
 /*==================[external functions declaration]=========================*/
@@ -51,6 +128,47 @@ typedef struct {
  */
 void UartInit(serial_config_t *port_config);
 
+/**
+ * @brief Serial port initialization in line mode
+ * 
+ * The UART detects the delimiter in hardware and complete lines are read from the reception 
+ * ring buffer in a single call, without per-byte callbacks or read timeouts. The delimiter 
+ * (and a preceding '\r') is removed and the line is dispatched by its first word to the 
+ * matching command of the table. Callbacks run in the UART event task.
+ * 
+ * @param line_config 
+ */
+void UartLineInit(uart_line_config_t *line_config);
+
+/**
+ * @brief Read the event counters of a port
+ * 
+ * @param port Port selected
+ * @param stats Pointer to struct where counters will be stored
+ */
+void UartGetStats(uart_mcu_port_t port, uart_stats_t *stats);
+
+/**
+ * @brief Clear the event counters of a port
+ * 
+ * @param port Port selected
+ */
+void UartResetStats(uart_mcu_port_t port);
+
+/**
+ * @brief Measure sustained throughput with TX internally connected to RX
+ * 
+ * @note While it runs, reception callbacks and line mode commands of the port are not called 
+ * (received data belongs to the benchmark), but a callback already running keeps reading 
+ * until it returns: start it when the port is idle. CPU load does not include the time 
+ * spent in the UART interrupt.
+ * 
+ * @param port Port selected (already initialized)
+ * @param duration Benchmark duration (in ms)
+ * @param result Pointer to struct where results will be stored
+ */
+void UartLoopbackBenchmark(uart_mcu_port_t port, uint32_t duration, uart_bench_t *result);
+
 /**
  * @brief Read a single byte from serial port
  * 
@@ -91,17 +209,87 @@ void UartSendString(uart_mcu_port_t port, const char *msg);
 /**
  * @brief Send multiple bytes through serial port
  * 
+ * @note Blocks only while there is no room for data in the transmission ring buffer.
+ * 
  * @param port Port for sending data
  * @param data Pointer to array of data to be transmitted
  * @param nbytes Number of bytes to be sended
  */
-void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes);
+void UartSendBuffer(uart_mcu_port_t port, const char *data, uint16_t nbytes);
+
+/**
+ * @brief Queue multiple bytes for transmission without blocking
+ * 
+ * Only the bytes that fit in the asynchronous transmission queue are queued. The queue and 
+ * its task are created on the first call.
+ * 
+ * @note Bytes queued here keep their order, but a later blocking send on the same port 
+ * (UartSendBuffer(), UartSendString(), ...) can reach the line before them.
+ * 
+ * @param port Port for sending data
+ * @param data Pointer to array of data to be transmitted
+ * @param nbytes Number of bytes to be sended
+ * @return Number of bytes queued (the rest must be sent again)
+ */
+uint16_t UartSendBufferAsync(uart_mcu_port_t port, const char *data, uint16_t nbytes);
+
+/**
+ * @brief Queue a whole buffer for transmission without blocking, or nothing if it doesn't fit
+ * 
+ * Same queue as UartSendBufferAsync(), for framed protocols where a partial frame would 
+ * corrupt the stream.
+ * 
+ * @param port Port for sending data
+ * @param data Pointer to array of data to be transmitted
+ * @param nbytes Number of bytes to be sended
+ * @return true if every byte was queued
+ */
+bool UartSendFrameAsync(uart_mcu_port_t port, const char *data, uint16_t nbytes);
+
+/**
+ * @brief Number of bytes queued (asynchronous queue and transmission ring buffer) and not yet moved to the FIFO
+ * 
+ * @note Bytes in the asynchronous queue are counted exactly, but the transmission ring is 
+ * measured by its used space, which includes the driver's item headers: the result is an 
+ * upper bound that reaches 0 when everything was moved to the FIFO.
+ * 
+ * @param port Port selected
+ * @return Bytes in flight (upper bound)
+ */
+uint16_t UartTxPending(uart_mcu_port_t port);
+
+/**
+ * @brief Wait until every queued byte has been transmitted
+ * 
+ * @param port Port selected
+ * @param timeout Maximum wait (in ms)
+ * @return true if transmission is done, false on timeout
+ */
+bool UartTxWaitDone(uart_mcu_port_t port, uint32_t timeout);
+
+/**
+ * @brief Set a function to call when asynchronous transmission is done
+ * 
+ * The transmission task calls it, after the asynchronous queue runs dry, once the last byte 
+ * has left the line (blocking sends on the same port are waited for too). Bytes queued during 
+ * the wait delay the call until the queue is empty again.
+ * 
+ * @note The function runs on the transmission task: it must not block, and can queue more data.
+ * 
+ * @param port Port selected
+ * @param func_p Function to call (void func(void *param), NULL to disable)
+ * @param param_p Pointer to callback function parameters
+ */
+void UartSetTxDoneCallback(uart_mcu_port_t port, void *func_p, void *param_p);
 
 /**
  * @brief Convert a number to a String (char array ended with '\0')
  * 
+ * @note Result is stored in a static buffer shared by every caller (not reentrant). 
+ * Use FormatUint32Base() and the rest of format_mcu.h with a local buffer instead.
+ * 
  * @param val Number to be converted
- * @param base Base of the converted number (2: binary, 10: decimal, 16: hexadecimal)
+ * @param base Base of the converted number (2 to 16, e.g. 2: binary, 10: decimal, 16: hexadecimal; empty string otherwise)
  * @return uint8_t* 
  */
 uint8_t* UartItoa(uint32_t val, uint8_t base);
@@ -11,21 +11,187 @@
 
 /*==================[inclusions]=============================================*/
 #include "analog_io_mcu.h"
+#include <string.h>
 #include "driver/gptimer.h"
 #include "driver/sdm.h"
 #include "esp_adc/adc_cali_scheme.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_adc/adc_continuous.h"
+#include "timer_mcu.h"
+#include "freertos/queue.h"
+#include "esp_heap_caps.h"
 /*==================[macros and definitions]=================================*/
 #define ADC_BITWIDTH 		SOC_ADC_DIGI_MAX_BITWIDTH	// 12 bit resolution
 #define ADC_ATTENUATION		ADC_ATTEN_DB_12				// 12dB attenuation (for 0-3,3V ADC range)
+#define ADC_CONT_RESULT_BYTES	SOC_ADC_DIGI_RESULT_BYTES	// bytes per conversion result in continuous mode
+#define ADC_CONT_READ_TIMEOUT	1000						// max time waiting for a frame (in ms)
+#define ADC_CONT_SLOT_QTY		16							// hardware channel field is 4 bits wide
+#define ADC_CONT_NO_SLOT		0xFF
+#define ADC_RAW_QTY				(1 << ADC_BITWIDTH)			// calibration table entries
+#define CLOCK_RESOLUTION_HZ		10000000					// analog clock resolution (0.1us)
+#define DAC_OFFSET				128							// DAC value for 0 pulse density
+#define PLAYER_PHASE_BITS		16							// fractional bits of waveform players index
+#define ADC_Q15_SHIFT			(15 - (ADC_BITWIDTH - 1))	// scales a centered raw value to full Q15 range
 /*==================[internal data declaration]==============================*/
-adc_cali_handle_t adc_calibration_single_0, adc_calibration_single_1, adc_calibration_single_2, adc_calibration_single_3;
+const adc_channel_t adc_channel_list[] = {
+	ADC_CHANNEL_0,		/* CH0 */
+	ADC_CHANNEL_1,		/* CH1 */
+	ADC_CHANNEL_2,		/* CH2 */
+	ADC_CHANNEL_3,		/* CH3 */
+};
+adc_cali_handle_t adc_calibration[ADC_SCAN_CH_MAX] = {NULL};	/*!< Curve fitting scheme of each channel */
+static uint16_t *adc_cali_table[ADC_SCAN_CH_MAX] = {NULL};		/*!< raw to mV table of each channel (NULL if not calibrated) */
+static const uint16_t *adc_cont_table[ADC_SCAN_CH_MAX];			/*!< raw to mV table of each scan block */
 adc_oneshot_unit_handle_t adc1_single; 
-adc_continuous_handle_t adc2_cont;
+adc_continuous_handle_t adc1_cont = NULL;
 sdm_channel_handle_t dac = NULL;
 bool adc1_single_used = false;
+uint32_t adc_cont_sample_frec;				/*!< Sample frequency (of each channel) for continuous mode */
+uint16_t adc_cont_frame_size;				/*!< Samples per frame (of each channel) for continuous mode */
+adc_ch_t adc_cont_inputs[ADC_SCAN_CH_MAX];	/*!< Channels converted in continuous mode */
+uint8_t adc_cont_input_qty = 0;				/*!< Number of channels converted in continuous mode */
+adc_format_t adc_cont_format = ADC_FORMAT_U16;	/*!< Format of scan blocks */
+static uint8_t adc_cont_slot[ADC_CONT_SLOT_QTY];	/*!< Block index of each hardware channel (ADC_CONT_NO_SLOT if not scanned) */
+void (*adc_cont_isr_p)(void*) = NULL;		/*!< Pointer to the frame end callback */
+void *adc_cont_user_data;					/*!< Frame end callback parameter */
+static uint8_t adc_cont_frame[ADC_CONT_FRAME_SIZE_MAX * ADC_CONT_RESULT_BYTES];	/*!< Raw frame pulled from the driver ring */
+TaskHandle_t adc_lend_task = NULL;			/*!< Task notified when a frame is lent */
+QueueHandle_t adc_free_queue = NULL;		/*!< Frames owned by the driver */
+QueueHandle_t adc_ready_queue = NULL;		/*!< Frames waiting to be taken by adc_lend_task */
+uint32_t adc_frame_sequence = 0;			/*!< Number of frames completed since start */
+uint32_t adc_frame_period;					/*!< Duration of a frame (in us) */
+static analog_frame_t adc_frames[ADC_CONT_FRAME_QTY];									/*!< Frames lent to adc_lend_task */
+static int16_t adc_frames_data[ADC_CONT_FRAME_QTY][ADC_CONT_FRAME_SIZE_MAX];			/*!< Per-channel blocks of each frame */
+gptimer_handle_t analog_clock = NULL;		/*!< Timer shared by ADC sampling and DAC update */
+analog_clock_config_t analog_clock_config;	/*!< Analog clock configuration */
+uint16_t analog_clock_index = 0;			/*!< Sample index inside the current block */
+uint8_t analog_clock_block = 0;				/*!< Block (0 or 1) being sampled/updated */
+static uint16_t analog_clock_in[2][ANALOG_CLOCK_BLOCK_MAX];	/*!< ADC double buffer */
+static uint8_t analog_clock_out[2][ANALOG_CLOCK_BLOCK_MAX];	/*!< DAC double buffer */
+bool analog_clock_running = false;			/*!< Analog clock state */
+/**
+ * @brief Waveform player state
+ */
+typedef struct {
+	analog_player_config_t config;	/*!< Player configuration */
+	sdm_channel_handle_t sdm;		/*!< SDM channel used by the player */
+	uint16_t index;					/*!< Next sample to output */
+	uint32_t phase;					/*!< Fractional part of index */
+	uint32_t step;					/*!< Index increment per clock tick (PLAYER_PHASE_BITS fractional bits) */
+	bool active;					/*!< Player state */
+} analog_player_t;
+static analog_player_t analog_players[ANALOG_PLAYER_QTY];	/*!< Waveform players */
+uint64_t adc_single_timestamp[ADC_SCAN_CH_MAX];	/*!< Time of the last single read of each channel */
+uint64_t analog_clock_timestamp[2];			/*!< Time of the first sample of each analog clock block */
+static analog_timing_t analog_timing;		/*!< Jitter and latency histograms (percentiles computed on read) */
+bool analog_stats_on = false;				/*!< Statistics state */
+adc_ch_t analog_stats_channel;				/*!< Channel measured in single mode */
+static portMUX_TYPE analog_stats_lock = portMUX_INITIALIZER_UNLOCKED;
 /*==================[internal functions declaration]=========================*/
+static uint16_t AdcContSplit(const uint8_t *buffer, uint32_t length, void *blocks[]);
+
+static uint64_t IRAM_ATTR AnalogStatsClock(void){
+	return TimerGetUs();
+}
+
+static void IRAM_ATTR AnalogStatsEvent(uint64_t now){
+	portENTER_CRITICAL_SAFE(&analog_stats_lock);
+	AnalogTimingEventAt(&analog_timing, now);
+	portEXIT_CRITICAL_SAFE(&analog_stats_lock);
+}
+
+static bool IRAM_ATTR adc_cont_isr(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data){
+	BaseType_t task_woken = pdFALSE;
+	analog_frame_t *frame;
+	if(analog_stats_on){
+		AnalogStatsEvent(TimerGetUs());
+	}
+	if(adc_lend_task != NULL){
+		// split the DMA frame straight into a driver frame and lend it
+		if(xQueueReceiveFromISR(adc_free_queue, &frame, &task_woken) == pdTRUE){
+			frame->length = AdcContSplit(edata->conv_frame_buffer, edata->size, frame->data);
+			frame->timestamp = TimerGetUs() - adc_frame_period;
+			frame->sequence = adc_frame_sequence;
+			xQueueSendFromISR(adc_ready_queue, &frame, &task_woken);
+			vTaskNotifyGiveFromISR(adc_lend_task, &task_woken);
+		}
+		adc_frame_sequence++;
+	}
+	if(adc_cont_isr_p != NULL){
+		adc_cont_isr_p(adc_cont_user_data);
+	}
+	return (task_woken == pdTRUE);
+}
+
+static void IRAM_ATTR AnalogPlayersUpdate(void){
+	for(uint8_t p = 0; p < ANALOG_PLAYER_QTY; p++){
+		analog_player_t *player = &analog_players[p];
+		if(!player->active){
+			continue;
+		}
+		sdm_channel_set_pulse_density(player->sdm, (int8_t)(player->config.buffer[player->index] - DAC_OFFSET));
+		// sample rate conversion: index advances sample_frec / clock frequency samples per tick
+		player->phase += player->step;
+		uint16_t half = player->config.length / 2;
+		uint16_t index = player->index + (player->phase >> PLAYER_PHASE_BITS);
+		player->phase &= (1 << PLAYER_PHASE_BITS) - 1;
+		bool refill = false;
+		if(index >= player->config.length){
+			index -= player->config.length;
+			switch(player->config.mode){
+				case PLAYER_ONE_SHOT:
+					player->active = false;
+					refill = true;
+				break;
+				case PLAYER_LOOP:
+				break;
+				case PLAYER_STREAM:
+					refill = true;
+				break;
+			}
+		} else if((player->config.mode == PLAYER_STREAM) && (player->index < half) && (index >= half)){
+			refill = true;
+		}
+		player->index = index;
+		if(refill && (player->config.func_p != NULL)){
+			((void (*)(void*))player->config.func_p)(player->config.param_p);
+		}
+	}
+}
+
+static bool IRAM_ATTR analog_clock_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	int raw = 0;
+	uint16_t i = analog_clock_index;
+	uint8_t b = analog_clock_block;
+	AnalogPlayersUpdate();
+	if(analog_stats_on){
+		AnalogStatsEvent(TimerGetUs());
+	}
+	if(!analog_clock_config.sample_input && !analog_clock_config.update_output){
+		return true;
+	}
+	// DAC is updated first, so sample i is always acquired right after output i
+	if(analog_clock_config.update_output){
+		sdm_channel_set_pulse_density(dac, (int8_t)(analog_clock_out[b][i] - DAC_OFFSET));
+	}
+	if(analog_clock_config.sample_input){
+		if(i == 0){
+			analog_clock_timestamp[b] = TimerGetUs();
+		}
+		adc_oneshot_read_isr(adc1_single, adc_channel_list[analog_clock_config.input], &raw);
+		analog_clock_in[b][i] = (adc_cali_table[analog_clock_config.input] != NULL) ? 
+			adc_cali_table[analog_clock_config.input][raw] : raw;
+	}
+	if(++i >= analog_clock_config.block_size){
+		i = 0;
+		analog_clock_block = b ^ 1;
+		if(analog_clock_config.func_p != NULL){
+			((void (*)(void*))analog_clock_config.func_p)(analog_clock_config.param_p);
+		}
+	}
+	analog_clock_index = i;
+	return true;
+}
 
 /*==================[internal data definition]===============================*/
 adc_oneshot_unit_init_cfg_t init_config_single = {
@@ -39,7 +205,144 @@ adc_oneshot_chan_cfg_t adc_config_single = {
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static void AdcCaliCreate(adc_ch_t channel){
+	if(adc_calibration[channel] != NULL){
+		return;
+	}
+	adc_cali_curve_fitting_config_t cali_config = {
+		.unit_id = ADC_UNIT_1,
+		.chan = adc_channel_list[channel], 
+		.atten = ADC_ATTENUATION,
+		.bitwidth = ADC_BITWIDTH,
+	};
+	ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config, &adc_calibration[channel]));
+}
+
+static uint16_t AdcContFrameSize(uint16_t frame_size, uint8_t input_qty){
+	if(frame_size == 0){
+		frame_size = ADC_CONT_FRAME_SIZE_DEFAULT / input_qty;
+	} else if(frame_size * input_qty > ADC_CONT_FRAME_SIZE_MAX){
+		frame_size = ADC_CONT_FRAME_SIZE_MAX / input_qty;
+	}
+	return frame_size;
+}
+
+static void AdcContStart(void){
+	adc_digi_pattern_config_t pattern[ADC_SCAN_CH_MAX];
+	uint32_t sample_frec = adc_cont_sample_frec * adc_cont_input_qty;
+	if(sample_frec < SOC_ADC_SAMPLE_FREQ_THRES_LOW){
+		sample_frec = SOC_ADC_SAMPLE_FREQ_THRES_LOW;
+	} else if(sample_frec > SOC_ADC_SAMPLE_FREQ_THRES_HIGH){
+		sample_frec = SOC_ADC_SAMPLE_FREQ_THRES_HIGH;
+	}
+	memset(adc_cont_slot, ADC_CONT_NO_SLOT, sizeof(adc_cont_slot));
+	for(uint8_t i = 0; i < adc_cont_input_qty; i++){
+		pattern[i].atten = ADC_ATTENUATION;
+		pattern[i].channel = adc_channel_list[adc_cont_inputs[i]];
+		pattern[i].unit = ADC_UNIT_1;
+		pattern[i].bit_width = ADC_BITWIDTH;
+		adc_cont_slot[pattern[i].channel] = i;
+		// lent frames are kept raw to keep the ISR short, see AnalogFrameToMv()
+		adc_cont_table[i] = (adc_lend_task == NULL) ? adc_cali_table[adc_cont_inputs[i]] : NULL;
+	}
+	// driver ring: ADC_CONT_FRAME_QTY frames of whole pattern rounds, so every frame starts aligned
+	adc_continuous_handle_cfg_t handle_config = {
+		.max_store_buf_size = adc_cont_frame_size * adc_cont_input_qty * ADC_CONT_RESULT_BYTES * ADC_CONT_FRAME_QTY,
+		.conv_frame_size = adc_cont_frame_size * adc_cont_input_qty * ADC_CONT_RESULT_BYTES,
+	};
+	adc_frame_period = (uint64_t)adc_cont_frame_size * 1000000 / (sample_frec / adc_cont_input_qty);
+	adc_frame_sequence = 0;
+	if(adc_lend_task != NULL){
+		// frames are taken from the DMA buffer in the ISR, the driver ring is not read
+		handle_config.max_store_buf_size = handle_config.conv_frame_size;
+		handle_config.flags.flush_pool = 1;
+		xQueueReset(adc_free_queue);
+		xQueueReset(adc_ready_queue);
+		for(uint8_t i = 0; i < ADC_CONT_FRAME_QTY; i++){
+			analog_frame_t *frame = &adc_frames[i];
+			for(uint8_t j = 0; j < adc_cont_input_qty; j++){
+				frame->data[j] = &adc_frames_data[i][j * adc_cont_frame_size];
+				frame->channel[j] = adc_cont_inputs[j];
+			}
+			frame->channel_qty = adc_cont_input_qty;
+			xQueueSend(adc_free_queue, &frame, 0);
+		}
+	}
+	ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_config, &adc1_cont));
+	adc_continuous_config_t cont_config = {
+		.pattern_num = adc_cont_input_qty,
+		.adc_pattern = pattern,
+		.sample_freq_hz = sample_frec,
+		.conv_mode = ADC_CONV_SINGLE_UNIT_1,
+		.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+	};
+	ESP_ERROR_CHECK(adc_continuous_config(adc1_cont, &cont_config));
+	adc_continuous_evt_cbs_t cont_callbacks = {
+		.on_conv_done = adc_cont_isr,
+	};
+	ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc1_cont, &cont_callbacks, NULL));
+	ESP_ERROR_CHECK(adc_continuous_start(adc1_cont));
+}
 
+/**
+ * @brief Split a raw frame in per-channel blocks in a single pass.
+ * 
+ * Each block takes up to adc_cont_frame_size samples: extra results of a misaligned frame are 
+ * discarded.
+ * 
+ * @param buffer Raw conversion results
+ * @param length Lenght of buffer (in bytes)
+ * @param blocks One pointer per scanned channel (NULL to discard that channel)
+ * @return Number of samples stored in each block
+ */
+static uint16_t IRAM_ATTR AdcContSplit(const uint8_t *buffer, uint32_t length, void *blocks[]){
+	uint16_t count[ADC_SCAN_CH_MAX] = {0};
+	uint16_t samples = UINT16_MAX;
+	const adc_digi_output_data_t *result = (const adc_digi_output_data_t*)buffer;
+	uint32_t result_qty = length / ADC_CONT_RESULT_BYTES;
+	if(adc_cont_format == ADC_FORMAT_U16){
+		for(uint32_t i = 0; i < result_qty; i++){
+			uint8_t slot = adc_cont_slot[result[i].type2.channel];
+			if((slot != ADC_CONT_NO_SLOT) && (blocks[slot] != NULL) && (count[slot] < adc_cont_frame_size)){
+				uint16_t data = result[i].type2.data;
+				// calibration is applied in the same pass
+				((uint16_t*)blocks[slot])[count[slot]++] = (adc_cont_table[slot] != NULL) ? adc_cont_table[slot][data] : data;
+			}
+		}
+	} else {
+		int32_t scale = (adc_cont_format == ADC_FORMAT_Q15) ? (1 << ADC_Q15_SHIFT) : 1;
+		for(uint32_t i = 0; i < result_qty; i++){
+			uint8_t slot = adc_cont_slot[result[i].type2.channel];
+			if((slot != ADC_CONT_NO_SLOT) && (blocks[slot] != NULL) && (count[slot] < adc_cont_frame_size)){
+				((int16_t*)blocks[slot])[count[slot]++] = (int16_t)(((int32_t)result[i].type2.data - ADC_MID_SCALE) * scale);
+			}
+		}
+	}
+	for(uint8_t i = 0; i < adc_cont_input_qty; i++){
+		if((blocks[i] != NULL) && (count[i] < samples)){
+			samples = count[i];
+		}
+	}
+	return (samples == UINT16_MAX) ? 0 : samples;
+}
+
+/**
+ * @brief Pull one frame from the driver ring and split it in per-channel blocks.
+ * 
+ * @param blocks One pointer per scanned channel (NULL to discard that channel)
+ * @return Number of samples stored in each block
+ */
+static uint16_t AdcContRead(void *blocks[]){
+	uint32_t length = 0;
+	if((adc1_cont == NULL) || (adc_lend_task != NULL)){
+		return 0;
+	}
+	if(adc_continuous_read(adc1_cont, adc_cont_frame, adc_cont_frame_size * adc_cont_input_qty * ADC_CONT_RESULT_BYTES, 
+		&length, ADC_CONT_READ_TIMEOUT) != ESP_OK){
+		return 0;
+	}
+	return AdcContSplit(adc_cont_frame, length, blocks);
+}
 /*==================[external functions definition]==========================*/
 
 void AnalogInputInit(analog_input_config_t *config){
@@ -51,67 +354,23 @@ void AnalogInputInit(analog_input_config_t *config){
 				adc_oneshot_new_unit(&init_config_single, &adc1_single);
 				adc1_single_used = true;
 			}
-			switch(config->input){
-				case CH0:
-    				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_0, &adc_config_single);
-					// create calibration curve
-					adc_cali_curve_fitting_config_t cali_config_0 = {
-						.unit_id = ADC_UNIT_1,
-						.chan = ADC_CHANNEL_0, 
-						.atten = ADC_ATTENUATION,
-						.bitwidth = ADC_BITWIDTH,
-					};
-					ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config_0, &adc_calibration_single_0));
-				break;
-				case CH1:
-    				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_1, &adc_config_single);
-					// create calibration curve
-					adc_cali_curve_fitting_config_t cali_config_1 = {
-						.unit_id = ADC_UNIT_1,
-						.chan = ADC_CHANNEL_1, 
-						.atten = ADC_ATTENUATION,
-						.bitwidth = ADC_BITWIDTH,
-					};
-					ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config_1, &adc_calibration_single_1));
-				break;
-				case CH2:
-    				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_2, &adc_config_single);
-					// create calibration curve
-					adc_cali_curve_fitting_config_t cali_config_2 = {
-						.unit_id = ADC_UNIT_1,
-						.chan = ADC_CHANNEL_2, 
-						.atten = ADC_ATTENUATION,
-						.bitwidth = ADC_BITWIDTH,
-					};
-					ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config_2, &adc_calibration_single_2));
-				break;
-				case CH3:
-    				adc_oneshot_config_channel(adc1_single, ADC_CHANNEL_3, &adc_config_single);
-					// create calibration curve
-					adc_cali_curve_fitting_config_t cali_config_3 = {
-						.unit_id = ADC_UNIT_1,
-						.chan = ADC_CHANNEL_3, 
-						.atten = ADC_ATTENUATION,
-						.bitwidth = ADC_BITWIDTH,
-					};
-					ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config_3, &adc_calibration_single_3));
-				break;
+			adc_oneshot_config_channel(adc1_single, adc_channel_list[config->input], &adc_config_single);
+			// create calibration curve
+			AdcCaliCreate(config->input);
+			if(config->calibrated){
+				AnalogCalibrationInit(config->input);
 			}
 		break;
 		case ADC_CONTINUOUS:
-			switch(config->input){
-				case CH0:
-
-				break;
-				case CH1:
-
-				break;
-				case CH2:
-
-				break;
-				case CH3:
-
-				break;
+			adc_cont_inputs[0] = config->input;
+			adc_cont_input_qty = 1;
+			adc_cont_format = ADC_FORMAT_U16;
+			adc_cont_sample_frec = config->sample_frec;
+			adc_cont_frame_size = AdcContFrameSize(config->frame_size, adc_cont_input_qty);
+			adc_cont_isr_p = config->func_p;
+			adc_cont_user_data = config->param_p;
+			if(config->calibrated){
+				AnalogCalibrationInit(config->input);
 			}
 		break;
 	}
@@ -128,39 +387,295 @@ void AnalogOutputInit(void){
 }
 
 void AnalogInputReadSingle(adc_ch_t channel, uint16_t *value){
-    switch(channel){
-		case CH0:
-			adc_oneshot_read(adc1_single, ADC_CHANNEL_0, (int*)value);
-		break;
-		case CH1:
-			adc_oneshot_read(adc1_single, ADC_CHANNEL_1, (int*)value);
-		break;
-		case CH2:
-			adc_oneshot_read(adc1_single, ADC_CHANNEL_2, (int*)value);
-		break;
-		case CH3:
-			adc_oneshot_read(adc1_single, ADC_CHANNEL_3, (int*)value);
-		break;
+	int raw = 0;
+	uint64_t now = TimerGetUs();
+	adc_oneshot_read(adc1_single, adc_channel_list[channel], &raw);
+	*value = (adc_cali_table[channel] != NULL) ? adc_cali_table[channel][raw] : raw;
+	adc_single_timestamp[channel] = now;
+	if(analog_stats_on && (channel == analog_stats_channel)){
+		AnalogStatsEvent(now);
 	}
 }
 
-void AnalogStartContinuous(adc_ch_t channel){
+uint64_t AnalogInputTimestamp(adc_ch_t channel){
+	return adc_single_timestamp[channel];
+}
 
+void AnalogStartContinuous(adc_ch_t channel){
+	if(adc1_cont != NULL){
+		return;
+	}
+	adc_cont_inputs[0] = channel;
+	adc_cont_input_qty = 1;
+	adc_cont_format = ADC_FORMAT_U16;
+	AdcContStart();
 }
 
 void AnalogStopContinuous(adc_ch_t channel){
+	if(adc1_cont == NULL){
+		return;
+	}
+	adc_continuous_stop(adc1_cont);
+	adc_continuous_deinit(adc1_cont);
+	adc1_cont = NULL;
+}
+
+uint16_t AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values){
+	void *blocks[ADC_SCAN_CH_MAX] = {NULL};
+	for(uint8_t i = 0; i < adc_cont_input_qty; i++){
+		if(adc_cont_inputs[i] == channel){
+			blocks[i] = values;
+		}
+	}
+	return AdcContRead(blocks);
+}
+
+void AnalogScanInit(analog_scan_config_t *config){
+	adc_cont_input_qty = (config->input_qty > ADC_SCAN_CH_MAX) ? ADC_SCAN_CH_MAX : config->input_qty;
+	memcpy(adc_cont_inputs, config->inputs, adc_cont_input_qty * sizeof(adc_ch_t));
+	if(config->calibrated){
+		for(uint8_t i = 0; i < adc_cont_input_qty; i++){
+			AnalogCalibrationInit(adc_cont_inputs[i]);
+		}
+	}
+	adc_cont_format = config->format;
+	adc_cont_sample_frec = config->sample_frec;
+	adc_cont_frame_size = AdcContFrameSize(config->frame_size, adc_cont_input_qty);
+	adc_cont_isr_p = config->func_p;
+	adc_cont_user_data = config->param_p;
+}
+
+void AnalogScanStart(void){
+	if((adc1_cont != NULL) || (adc_cont_input_qty == 0)){
+		return;
+	}
+	AdcContStart();
+}
+
+void AnalogScanStop(void){
+	AnalogStopContinuous(adc_cont_inputs[0]);
+}
+
+uint16_t AnalogScanRead(void *blocks[]){
+	return AdcContRead(blocks);
+}
+
+bool AnalogCalibrationInit(adc_ch_t channel){
+	int voltage = 0;
+	if(adc_cali_table[channel] != NULL){
+		return true;
+	}
+	uint16_t *table = heap_caps_malloc(ADC_RAW_QTY * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+	if(table == NULL){
+		return false;
+	}
+	AdcCaliCreate(channel);
+	for(uint16_t raw = 0; raw < ADC_RAW_QTY; raw++){
+		adc_cali_raw_to_voltage(adc_calibration[channel], raw, &voltage);
+		table[raw] = voltage;
+	}
+	adc_cali_table[channel] = table;
+	return true;
+}
 
+void AnalogRawToMv(adc_ch_t channel, const uint16_t *raw, uint16_t *mv, uint16_t length){
+	const uint16_t *table = adc_cali_table[channel];
+	uint16_t i = 0;
+	if(table == NULL){
+		return;
+	}
+	for(; i + 4 <= length; i += 4){
+		mv[i] = table[raw[i] & (ADC_RAW_QTY - 1)];
+		mv[i + 1] = table[raw[i + 1] & (ADC_RAW_QTY - 1)];
+		mv[i + 2] = table[raw[i + 2] & (ADC_RAW_QTY - 1)];
+		mv[i + 3] = table[raw[i + 3] & (ADC_RAW_QTY - 1)];
+	}
+	for(; i < length; i++){
+		mv[i] = table[raw[i] & (ADC_RAW_QTY - 1)];
+	}
 }
 
-void AnalogInputReadContinuous(adc_ch_t channel, uint16_t *values){
+void AnalogFrameToMv(analog_frame_t *frame){
+	for(uint8_t i = 0; i < frame->channel_qty; i++){
+		AnalogRawToMv(frame->channel[i], frame->data[i], frame->data[i], frame->length);
+	}
+}
 
+void AnalogFrameSubscribe(TaskHandle_t task){
+	if(adc_free_queue == NULL){
+		adc_free_queue = xQueueCreate(ADC_CONT_FRAME_QTY, sizeof(analog_frame_t*));
+		adc_ready_queue = xQueueCreate(ADC_CONT_FRAME_QTY, sizeof(analog_frame_t*));
+	}
+	adc_lend_task = task;
+}
+
+bool AnalogFrameTake(analog_frame_t **frame){
+	if(adc_ready_queue == NULL){
+		return false;
+	}
+	if(xQueueReceive(adc_ready_queue, frame, 0) != pdTRUE){
+		return false;
+	}
+	if(analog_stats_on){
+		portENTER_CRITICAL(&analog_stats_lock);
+		AnalogTimingLatency(&analog_timing, (*frame)->timestamp + adc_frame_period);
+		portEXIT_CRITICAL(&analog_stats_lock);
+	}
+	return true;
+}
+
+void AnalogFrameGive(analog_frame_t *frame){
+	xQueueSend(adc_free_queue, &frame, 0);
 }
 
 void AnalogOutputWrite(uint8_t value){
-	int8_t density = value - 128;
+	int8_t density = value - DAC_OFFSET;
 	sdm_channel_set_pulse_density(dac, density);
 }
 
+void AnalogClockInit(analog_clock_config_t *config){
+	if(config->sample_frec == 0){
+		return;
+	}
+	analog_clock_config = *config;
+	if(analog_clock_config.block_size > ANALOG_CLOCK_BLOCK_MAX){
+		analog_clock_config.block_size = ANALOG_CLOCK_BLOCK_MAX;
+	}
+	memset(analog_clock_out, DAC_OFFSET, sizeof(analog_clock_out));
+	analog_clock_index = 0;
+	analog_clock_block = 0;
+	if(analog_clock == NULL){
+		gptimer_config_t clock_config = {
+			.clk_src = GPTIMER_CLK_SRC_DEFAULT,
+			.direction = GPTIMER_COUNT_UP,
+			.resolution_hz = CLOCK_RESOLUTION_HZ,
+		};
+		ESP_ERROR_CHECK(gptimer_new_timer(&clock_config, &analog_clock));
+		gptimer_event_callbacks_t clock_alarm = {
+			.on_alarm = analog_clock_isr,
+		};
+		gptimer_register_event_callbacks(analog_clock, &clock_alarm, NULL);
+		gptimer_enable(analog_clock);
+	}
+	gptimer_alarm_config_t alarm_config = {
+		.alarm_count = CLOCK_RESOLUTION_HZ / analog_clock_config.sample_frec,
+		.reload_count = 0,
+		.flags.auto_reload_on_alarm = true,
+	};
+	gptimer_set_alarm_action(analog_clock, &alarm_config);
+}
+
+void AnalogClockStart(void){
+	if(analog_clock_running){
+		return;
+	}
+	gptimer_set_raw_count(analog_clock, 0);
+	gptimer_start(analog_clock);
+	analog_clock_running = true;
+}
+
+void AnalogClockStop(void){
+	if(!analog_clock_running){
+		return;
+	}
+	gptimer_stop(analog_clock);
+	analog_clock_running = false;
+}
+
+uint16_t* AnalogClockInputBlock(void){
+	return analog_clock_in[analog_clock_block ^ 1];
+}
+
+uint8_t* AnalogClockOutputBlock(void){
+	return analog_clock_out[analog_clock_block ^ 1];
+}
+
+uint64_t AnalogClockInputTimestamp(void){
+	return analog_clock_timestamp[analog_clock_block ^ 1];
+}
+
+void AnalogPlayerInit(analog_player_config_t *config){
+	analog_player_t *player = &analog_players[config->player];
+	player->active = false;
+	player->config = *config;
+	if(player->sdm == NULL){
+		sdm_config_t sdm_config = {
+			.clk_src = SDM_CLK_SRC_DEFAULT,
+			.sample_rate_hz = 1 * 1000 * 1000,
+			.gpio_num = config->pin,
+		};
+		ESP_ERROR_CHECK(sdm_new_channel(&sdm_config, &player->sdm));
+		sdm_channel_enable(player->sdm);
+	}
+	if(analog_clock == NULL){
+		analog_clock_config_t clock_config = {
+			.sample_frec = config->sample_frec,
+		};
+		AnalogClockInit(&clock_config);
+	}
+}
+
+void AnalogPlayerLoad(analog_player_num_t player, uint8_t *buffer, uint16_t length){
+	analog_players[player].active = false;
+	analog_players[player].config.buffer = buffer;
+	analog_players[player].config.length = length;
+}
+
+bool AnalogPlayerStart(analog_player_num_t player){
+	analog_player_t *p = &analog_players[player];
+	if((p->config.buffer == NULL) || (p->config.length == 0)){
+		return false;
+	}
+	/* the analog clock must be configured (AnalogClockInit() or AnalogPlayerInit()) */
+	if((analog_clock == NULL) || (analog_clock_config.sample_frec == 0)){
+		return false;
+	}
+	/* the index advances at most one sample per tick (single wrap in AnalogPlayersUpdate()) */
+	if(p->config.sample_frec > analog_clock_config.sample_frec){
+		return false;
+	}
+	p->index = 0;
+	p->phase = 0;
+	p->step = ((uint64_t)p->config.sample_frec << PLAYER_PHASE_BITS) / analog_clock_config.sample_frec;
+	p->active = true;
+	AnalogClockStart();
+	return true;
+}
+
+void AnalogPlayerStop(analog_player_num_t player){
+	analog_players[player].active = false;
+	sdm_channel_set_pulse_density(analog_players[player].sdm, 0);
+}
+
+bool AnalogPlayerIsActive(analog_player_num_t player){
+	return analog_players[player].active;
+}
+
+uint8_t* AnalogPlayerRefillBlock(analog_player_num_t player){
+	analog_player_t *p = &analog_players[player];
+	uint16_t half = p->config.length / 2;
+	return (p->index < half) ? &p->config.buffer[half] : p->config.buffer;
+}
+
+void AnalogStatsStart(adc_ch_t channel, uint32_t period, uint16_t bin_width){
+	portENTER_CRITICAL(&analog_stats_lock);
+	AnalogTimingInit(&analog_timing, AnalogStatsClock, period, bin_width);
+	analog_stats_channel = channel;
+	analog_stats_on = true;
+	portEXIT_CRITICAL(&analog_stats_lock);
+}
+
+void AnalogStatsStop(void){
+	analog_stats_on = false;
+}
+
+void AnalogStatsGet(analog_hist_t hist, analog_stats_t *stats){
+	portENTER_CRITICAL(&analog_stats_lock);
+	*stats = analog_timing.hist[hist];
+	portEXIT_CRITICAL(&analog_stats_lock);
+	AnalogStatsSummary(stats);
+}
+
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
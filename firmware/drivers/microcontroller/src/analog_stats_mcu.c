@@ -0,0 +1,71 @@
+/**
+ * @file analog_stats_mcu.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include "analog_stats_mcu.h"
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+void AnalogTimingInit(analog_timing_t *timing, uint64_t (*clock_p)(void), uint32_t period, uint16_t bin_width){
+	if(bin_width == 0){
+		bin_width = 1;
+	}
+	memset(timing, 0, sizeof(analog_timing_t));
+	timing->hist[ANALOG_HIST_JITTER].bin_width = bin_width;
+	timing->hist[ANALOG_HIST_JITTER].first_bin = -(ANALOG_HIST_BINS / 2) * bin_width;
+	timing->hist[ANALOG_HIST_LATENCY].bin_width = bin_width;
+	timing->hist[ANALOG_HIST_LATENCY].first_bin = 0;
+	timing->clock_p = clock_p;
+	timing->period = period;
+}
+
+int32_t AnalogStatsPercentile(const analog_stats_t *stats, uint8_t percent){
+	uint32_t target = ((uint64_t)stats->count * percent + 99) / 100;
+	uint32_t acc = 0;
+	int32_t value = stats->max;
+	if(stats->count == 0){
+		return 0;
+	}
+	for(uint8_t i = 0; i < ANALOG_HIST_BINS; i++){
+		acc += stats->bins[i];
+		if(acc >= target){
+			value = stats->first_bin + (i + 1) * stats->bin_width;
+			break;
+		}
+	}
+	// edge bins also hold out of range values: max/min bound them
+	if((value > stats->max) || (value >= stats->first_bin + ANALOG_HIST_BINS * stats->bin_width)){
+		value = stats->max;
+	}
+	if(value < stats->min){
+		value = stats->min;
+	}
+	return value;
+}
+
+void AnalogStatsSummary(analog_stats_t *stats){
+	stats->p50 = AnalogStatsPercentile(stats, 50);
+	stats->p90 = AnalogStatsPercentile(stats, 90);
+	stats->p99 = AnalogStatsPercentile(stats, 99);
+}
+
+/*==================[end of file]============================================*/
@@ -11,65 +11,135 @@
 
 /*==================[inclusions]=============================================*/
 #include "delay_mcu.h"
-#include "driver/gptimer.h"
+#include "timer_mcu.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_rom_sys.h"
 /*==================[macros and definitions]=================================*/
-#define US_RESOLUTION_HZ	1000000	/*!< 1usec */
 #define MSEC				1000	/*!< 1msec = 1000usec */
 #define SEC					1000000	/*!< 1sec = 1000msec */
-#define MIN_US				50	    /*!< minimun delay in usec to use gptimer */
+#define MIN_US				50	    /*!< minimun delay in usec to use the delay queue */
 #define MIN_MS				100	    /*!< minimun delay in msec to use vTaskDelay */
 /*==================[internal data declaration]==============================*/
-SemaphoreHandle_t xDelaySemaphore = NULL;
+/**
+ * @brief Delay queue node (lives in the stack of the delayed task)
+ */
+typedef struct delay_node {
+	uint64_t deadline;					/*!< Wake up time (in us, see TimerGetUs()) */
+	SemaphoreHandle_t done;				/*!< Given when the deadline is reached */
+	StaticSemaphore_t done_buffer;		/*!< Storage for done */
+	struct delay_node *next;			/*!< Next node (later deadline) */
+} delay_node_t;
+timer_handle_t delay_timer = NULL;		/*!< One-shot timer armed to the nearest deadline */
+static delay_node_t *delay_queue = NULL;	/*!< Delayed tasks, ordered by deadline */
+static portMUX_TYPE delay_lock = portMUX_INITIALIZER_UNLOCKED;
+uint32_t delay_cycles_overhead = 0;		/*!< CPU cycles spent by a DelayCycles(0) call */
 /*==================[internal functions declaration]=========================*/
-static bool IRAM_ATTR delay_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+/**
+ * @brief Arm delay_timer to the first deadline of the queue (must be called with delay_lock taken)
+ */
+static void IRAM_ATTR DelayTimerUpdate(void){
+	if(delay_queue == NULL){
+		return;
+	}
+	uint64_t now = TimerGetUs();
+	TimerDisarm(delay_timer);
+	TimerSetPeriod(delay_timer, (delay_queue->deadline > now) ? (delay_queue->deadline - now) : 0);
+	TimerArm(delay_timer);
+}
+
+static void IRAM_ATTR delay_isr(void *param){
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-	gptimer_stop(timer);
-	xSemaphoreGiveFromISR(xDelaySemaphore, &xHigherPriorityTaskWoken);
-	return (xHigherPriorityTaskWoken == pdTRUE);
+	portENTER_CRITICAL_ISR(&delay_lock);
+	uint64_t now = TimerGetUs();
+	while((delay_queue != NULL) && (delay_queue->deadline <= now)){
+		xSemaphoreGiveFromISR(delay_queue->done, &xHigherPriorityTaskWoken);
+		delay_queue = delay_queue->next;
+	}
+	DelayTimerUpdate();
+	portEXIT_CRITICAL_ISR(&delay_lock);
+	// run the woken task now, not at the next tick
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief Create delay_timer (first call only)
+ */
+static void DelayTimerInit(void){
+	if(delay_timer != NULL){
+		return;
+	}
+	timer_handle_config_t config = {
+		.period = 0,
+		.one_shot = true,
+		.func_p = delay_isr,
+		.param_p = NULL,
+	};
+	timer_handle_t timer = TimerCreate(&config);
+	portENTER_CRITICAL(&delay_lock);
+	if(delay_timer == NULL){
+		delay_timer = timer;
+		timer = NULL;
+	}
+	portEXIT_CRITICAL(&delay_lock);
+	// another task created it first
+	if(timer != NULL){
+		TimerDelete(timer);
+	}
+}
+
+/**
+ * @brief Block the calling task for usec, using the delay queue
+ */
+static void DelayWait(uint32_t usec){
+	delay_node_t node;
+	DelayTimerInit();
+	node.done = xSemaphoreCreateBinaryStatic(&node.done_buffer);
+	node.deadline = TimerGetUs() + usec;
+	portENTER_CRITICAL(&delay_lock);
+	delay_node_t **prev = &delay_queue;
+	while((*prev != NULL) && ((*prev)->deadline <= node.deadline)){
+		prev = &(*prev)->next;
+	}
+	node.next = *prev;
+	*prev = &node;
+	if(delay_queue == &node){
+		DelayTimerUpdate();
+	}
+	portEXIT_CRITICAL(&delay_lock);
+	xSemaphoreTake(node.done, portMAX_DELAY);
+	vSemaphoreDelete(node.done);
+}
 
 /*==================[external functions definition]==========================*/
+void DelayCyclesCalibrate(void){
+	uint32_t min = UINT32_MAX;
+	delay_cycles_overhead = 0;
+	// shortest of several runs, to discard interrupts
+	for(uint8_t i = 0; i < 8; i++){
+		uint32_t start = esp_cpu_get_cycle_count();
+		DelayCycles(0);
+		uint32_t cycles = esp_cpu_get_cycle_count() - start;
+		if(cycles < min){
+			min = cycles;
+		}
+	}
+	delay_cycles_overhead = min;
+}
+
 void DelaySec(uint16_t sec){
     vTaskDelay(sec * MSEC / portTICK_PERIOD_MS);
 }
 
 void DelayMs(uint16_t msec){
-    // If the delay is too short, use the ESP32's internal timer
+    // If the delay is too short, use the delay queue
     if(msec<=MIN_MS){ 
-        if(xDelaySemaphore == NULL){
-            xDelaySemaphore = xSemaphoreCreateBinary();
-            gptimer_handle_t delay_timer = NULL;
-            gptimer_config_t delay_timer_config = {
-                .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-                .direction = GPTIMER_COUNT_UP,
-                .resolution_hz = US_RESOLUTION_HZ,
-            };
-            gptimer_new_timer(&delay_timer_config, &delay_timer);
-            gptimer_event_callbacks_t delay_alarm = {
-                .on_alarm = delay_isr,
-            };
-            gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL);
-            gptimer_enable(delay_timer);
-            gptimer_alarm_config_t alarm_config = {
-                .alarm_count = msec*MSEC, 
-            };
-            gptimer_set_alarm_action(delay_timer, &alarm_config);
-            gptimer_start(delay_timer);
-            if(xDelaySemaphore != NULL){
-                xSemaphoreTake(xDelaySemaphore, portMAX_DELAY);
-                xDelaySemaphore = NULL;
-            }
-            gptimer_disable(delay_timer);
-            gptimer_del_timer(delay_timer);
-        }
+        DelayWait(msec * MSEC);
     }else{       
         // If the delay is longer than the minimum delay, use vTaskDelay
         vTaskDelay(msec / portTICK_PERIOD_MS);
@@ -81,34 +151,7 @@ void DelayUs(uint16_t usec){
         /* If the delay is too short, use the ROM delay function */
         esp_rom_delay_us(usec);
     }else{
-        /* If the delay is longer than the minimum, use the ESP32's internal timer */
-        if(xDelaySemaphore == NULL){
-	        xDelaySemaphore = xSemaphoreCreateBinary();
-            gptimer_handle_t delay_timer = NULL;
-            gptimer_config_t delay_timer_config = {
-                .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-                .direction = GPTIMER_COUNT_UP,
-                .resolution_hz = US_RESOLUTION_HZ,
-            };
-            gptimer_new_timer(&delay_timer_config, &delay_timer);
-            gptimer_event_callbacks_t delay_alarm = {
-                .on_alarm = delay_isr,
-            };
-            gptimer_register_event_callbacks(delay_timer, &delay_alarm, NULL);
-            gptimer_enable(delay_timer);
-            gptimer_alarm_config_t alarm_config = {
-                .alarm_count = usec, 
-            };
-            gptimer_set_alarm_action(delay_timer, &alarm_config);
-            gptimer_start(delay_timer);
-            if(xDelaySemaphore != NULL){
-                /* Wait for the timer to finish */
-                xSemaphoreTake(xDelaySemaphore, portMAX_DELAY);
-                xDelaySemaphore = NULL;
-            }
-            gptimer_disable(delay_timer);
-            gptimer_del_timer(delay_timer);
-        }
+        /* If the delay is longer than the minimum, use the delay queue */
+        DelayWait(usec);
     }
 }
-
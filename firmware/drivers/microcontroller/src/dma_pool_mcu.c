@@ -0,0 +1,145 @@
+/**
+ * @file dma_pool_mcu.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "dma_pool_mcu.h"
+#include <stddef.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+/*==================[macros and definitions]=================================*/
+#define DMA_POOL_CAPS	(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL)	/*!< Memory capabilities of the pool regions */
+/*==================[internal data declaration]==============================*/
+/**
+ * @brief Free block (the link is stored in the block itself)
+ */
+typedef struct dma_block {
+	struct dma_block *next;		/*!< Next free block */
+} dma_block_t;
+
+/**
+ * @brief Size class state
+ */
+typedef struct {
+	uint8_t *region;			/*!< Memory of every block of the class */
+	dma_block_t *free_list;		/*!< First free block */
+	dma_pool_stats_t stats;		/*!< Usage statistics */
+} dma_class_t;
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static dma_class_t dma_classes[DMA_POOL_CLASSES] = {
+	{.stats = {.block_size = 64, .blocks = DMA_POOL_64_QTY}},
+	{.stats = {.block_size = 256, .blocks = DMA_POOL_256_QTY}},
+	{.stats = {.block_size = 1024, .blocks = DMA_POOL_1024_QTY}},
+	{.stats = {.block_size = 4092, .blocks = DMA_POOL_4092_QTY}},
+};	/*!< Size classes, from the smallest block size */
+static bool dma_pool_ready = false;							/*!< Pool memory allocated */
+static portMUX_TYPE dma_pool_lock = portMUX_INITIALIZER_UNLOCKED;	/*!< Protects the free lists */
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Size class of a block (DMA_POOL_CLASSES if not from the pool)
+ */
+static uint8_t IRAM_ATTR DmaPoolClass(const void *block){
+	const uint8_t *address = block;
+	for(uint8_t i = 0; i < DMA_POOL_CLASSES; i++){
+		dma_class_t *size_class = &dma_classes[i];
+		if(size_class->region != NULL && address >= size_class->region && 
+			address < size_class->region + size_class->stats.block_size * size_class->stats.blocks){
+			return i;
+		}
+	}
+	return DMA_POOL_CLASSES;
+}
+/*==================[external functions definition]==========================*/
+bool DmaPoolInit(void){
+	static bool dma_pool_complete = true;
+	if(dma_pool_ready){
+		return dma_pool_complete;
+	}
+	for(uint8_t i = 0; i < DMA_POOL_CLASSES; i++){
+		dma_class_t *size_class = &dma_classes[i];
+		uint16_t block_size = size_class->stats.block_size;
+		size_class->region = heap_caps_aligned_alloc(DMA_POOL_ALIGN, block_size * size_class->stats.blocks, DMA_POOL_CAPS);
+		if(size_class->region == NULL){
+			size_class->stats.blocks = 0;
+			dma_pool_complete = false;
+			continue;
+		}
+		size_class->free_list = NULL;
+		for(int16_t j = size_class->stats.blocks - 1; j >= 0; j--){
+			dma_block_t *block = (dma_block_t *)(size_class->region + j * block_size);
+			block->next = size_class->free_list;
+			size_class->free_list = block;
+		}
+	}
+	dma_pool_ready = true;
+	return dma_pool_complete;
+}
+
+void * IRAM_ATTR DmaPoolAlloc(uint32_t size){
+	dma_block_t *block = NULL;
+	uint8_t first = DMA_POOL_CLASSES;
+	portENTER_CRITICAL_SAFE(&dma_pool_lock);
+	for(uint8_t i = 0; i < DMA_POOL_CLASSES; i++){
+		dma_class_t *size_class = &dma_classes[i];
+		if(size_class->stats.block_size < size){
+			continue;
+		}
+		if(first == DMA_POOL_CLASSES){
+			first = i;
+		}
+		if(size_class->free_list != NULL){
+			block = size_class->free_list;
+			size_class->free_list = block->next;
+			size_class->stats.in_use++;
+			if(size_class->stats.in_use > size_class->stats.high_water){
+				size_class->stats.high_water = size_class->stats.in_use;
+			}
+			break;
+		}
+	}
+	if(block == NULL && first < DMA_POOL_CLASSES){
+		dma_classes[first].stats.failed++;
+	}
+	portEXIT_CRITICAL_SAFE(&dma_pool_lock);
+	return block;
+}
+
+void IRAM_ATTR DmaPoolFree(void *block){
+	uint8_t i = DmaPoolClass(block);
+	if(i == DMA_POOL_CLASSES){
+		return;
+	}
+	portENTER_CRITICAL_SAFE(&dma_pool_lock);
+	((dma_block_t *)block)->next = dma_classes[i].free_list;
+	dma_classes[i].free_list = block;
+	dma_classes[i].stats.in_use--;
+	portEXIT_CRITICAL_SAFE(&dma_pool_lock);
+}
+
+uint16_t DmaPoolBlockSize(const void *block){
+	uint8_t i = DmaPoolClass(block);
+	return (i == DMA_POOL_CLASSES) ? 0 : dma_classes[i].stats.block_size;
+}
+
+void DmaPoolGetStats(uint8_t size_class, dma_pool_stats_t *stats){
+	if(size_class >= DMA_POOL_CLASSES){
+		return;
+	}
+	portENTER_CRITICAL(&dma_pool_lock);
+	*stats = dma_classes[size_class].stats;
+	portEXIT_CRITICAL(&dma_pool_lock);
+}
+
+/*==================[end of file]============================================*/
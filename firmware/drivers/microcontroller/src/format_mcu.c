@@ -0,0 +1,189 @@
+/**
+ * @file format_mcu.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "format_mcu.h"
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define UINT32_DIGITS		10		/*!< Decimal digits of UINT32_MAX */
+#define FIXED_DECIMALS_MAX	9
+#define FLOAT_DECIMALS_MAX	6
+#define FLOAT_INT_MAX		4294967295.0f
+#define BASE_MIN			2
+#define BASE_MAX			16		/*!< Digits available in digits[] */
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static const char digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+static const char digits[] = "0123456789abcdef";
+static const uint32_t pow10_table[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Write val in decimal, left padded with zeros up to min_digits
+ */
+static uint8_t FormatDecimal(uint32_t val, uint8_t min_digits, char *buf){
+	char tmp[UINT32_DIGITS];
+	uint8_t i = UINT32_DIGITS;
+	while(val >= 100){
+		uint32_t r = val % 100;
+		val /= 100;
+		i -= 2;
+		memcpy(&tmp[i], &digit_pairs[2 * r], 2);
+	}
+	if(val >= 10){
+		i -= 2;
+		memcpy(&tmp[i], &digit_pairs[2 * val], 2);
+	} else {
+		tmp[--i] = '0' + val;
+	}
+	while(UINT32_DIGITS - i < min_digits){
+		tmp[--i] = '0';
+	}
+	uint8_t length = UINT32_DIGITS - i;
+	memcpy(buf, &tmp[i], length);
+	buf[length] = '\0';
+	return length;
+}
+
+/*==================[external functions definition]==========================*/
+uint8_t FormatUint32(uint32_t val, char *buf){
+	return FormatDecimal(val, 1, buf);
+}
+
+uint8_t FormatInt32(int32_t val, char *buf){
+	if(val < 0){
+		*buf = '-';
+		return 1 + FormatDecimal(-(uint32_t)val, 1, buf + 1);
+	}
+	return FormatDecimal(val, 1, buf);
+}
+
+uint8_t FormatUint32Base(uint32_t val, uint8_t base, char *buf){
+	char tmp[32];
+	uint8_t i = sizeof(tmp);
+	if((base < BASE_MIN) || (base > BASE_MAX)){
+		*buf = '\0';
+		return 0;
+	}
+	if(base == 10){
+		return FormatDecimal(val, 1, buf);
+	}
+	if((base & (base - 1)) == 0){
+		// powers of two: shift and mask instead of division
+		uint8_t shift = __builtin_ctz(base);
+		do{
+			tmp[--i] = digits[val & (base - 1)];
+			val >>= shift;
+		}while(val);
+	} else {
+		do{
+			tmp[--i] = digits[val % base];
+			val /= base;
+		}while(val);
+	}
+	uint8_t length = sizeof(tmp) - i;
+	memcpy(buf, &tmp[i], length);
+	buf[length] = '\0';
+	return length;
+}
+
+uint8_t FormatFixed(int32_t val, uint8_t decimals, char *buf){
+	uint8_t length = 0;
+	uint32_t abs_val = val;
+	if(decimals > FIXED_DECIMALS_MAX){
+		decimals = FIXED_DECIMALS_MAX;
+	}
+	if(val < 0){
+		buf[length++] = '-';
+		abs_val = -(uint32_t)val;
+	}
+	uint32_t int_part = abs_val / pow10_table[decimals];
+	length += FormatDecimal(int_part, 1, &buf[length]);
+	if(decimals > 0){
+		buf[length++] = '.';
+		length += FormatDecimal(abs_val - int_part * pow10_table[decimals], decimals, &buf[length]);
+	}
+	return length;
+}
+
+uint8_t FormatFloat(float val, uint8_t decimals, char *buf){
+	uint8_t length = 0;
+	if(val != val){
+		memcpy(buf, "nan", 4);
+		return 3;
+	}
+	if(decimals > FLOAT_DECIMALS_MAX){
+		decimals = FLOAT_DECIMALS_MAX;
+	}
+	if(val < 0){
+		buf[length++] = '-';
+		val = -val;
+	}
+	if(val >= FLOAT_INT_MAX){
+		memcpy(&buf[length], "ovf", 4);
+		return length + 3;
+	}
+	uint32_t int_part = (uint32_t)val;
+	uint32_t frac_part = (uint32_t)((val - int_part) * pow10_table[decimals] + 0.5f);
+	if(frac_part >= pow10_table[decimals]){
+		// rounding carried into the integer part
+		frac_part -= pow10_table[decimals];
+		int_part++;
+	}
+	length += FormatDecimal(int_part, 1, &buf[length]);
+	if(decimals > 0){
+		buf[length++] = '.';
+		length += FormatDecimal(frac_part, decimals, &buf[length]);
+	}
+	return length;
+}
+
+uint16_t FormatCsv(const int16_t *blocks[], uint8_t block_qty, uint16_t length, char *buf, uint16_t size){
+	uint16_t used = 0;
+	if((block_qty == 0) || (length == 0)){
+		return 0;
+	}
+	char line[block_qty * FORMAT_INT_SIZE + sizeof(FORMAT_CSV_EOL)];
+	for(uint16_t i = 0; i < length; i++){
+		uint16_t line_length = 0;
+		for(uint8_t b = 0; b < block_qty; b++){
+			line_length += FormatInt32(blocks[b][i], &line[line_length]);
+			line[line_length++] = ',';
+		}
+		// last separator is replaced by the line end
+		memcpy(&line[line_length - 1], FORMAT_CSV_EOL, sizeof(FORMAT_CSV_EOL));
+		line_length += sizeof(FORMAT_CSV_EOL) - 2;
+		if(used + line_length >= size){
+			break;
+		}
+		memcpy(&buf[used], line, line_length + 1);
+		used += line_length;
+	}
+	return used;
+}
+
+/*==================[end of file]============================================*/
@@ -13,46 +13,99 @@
 #include "gpio_fast_out_mcu.h"
 #include "gpio_mcu.h"
 #include <stdint.h>
-#include <string.h>
+#include <stdlib.h>
 #include "driver/gpio.h"
 #include "driver/dedic_gpio.h"
 /*==================[macros and definitions]=================================*/
 
 /*==================[internal data declaration]==============================*/
-dedic_gpio_bundle_handle_t bundleA = NULL;
-int bundleA_gpios[16];
+
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
+gpio_bundle_handle_t gpio_fast_bundle = NULL;	/*!< Bundle used by GPIOFastWrite() */
 
 /*==================[internal functions definition]==========================*/
 
 /*==================[external functions definition]==========================*/
-
-void GPIOFastInit(gpio_t *pin_list, uint8_t pin_qty){
-    memcpy(bundleA_gpios, pin_list, pin_qty);
+gpio_bundle_handle_t GPIOBundleCreate(gpio_bundle_config_t *config){
+    int gpios[GPIO_BUNDLE_PINS_MAX];
+    if(config->pin_qty == 0 || config->pin_qty > GPIO_BUNDLE_PINS_MAX){
+        return NULL;
+    }
     gpio_config_t io_conf = {
         .mode = GPIO_MODE_OUTPUT,
     };
-    for (int i = 0; i < pin_qty; i++) {
-        io_conf.pin_bit_mask = 1ULL << bundleA_gpios[i];
-        gpio_config(&io_conf);
-    }
-    // Create bundleA, output only
-    dedic_gpio_bundle_config_t bundleA_config = {
-        .gpio_array = bundleA_gpios,
-        .array_size = pin_qty,
+    switch(config->dir){
+        case GPIO_BUNDLE_INPUT:
+            io_conf.mode = GPIO_MODE_INPUT;
+        break;
+        case GPIO_BUNDLE_INOUT:
+            io_conf.mode = GPIO_MODE_INPUT_OUTPUT_OD;
+            io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+        break;
+        default:
+        break;
+    }
+    /* gpio_t and the driver's int pin numbers differ in size: copy them one by one */
+    for(uint8_t i = 0; i < config->pin_qty; i++){
+        gpios[i] = config->pin_list[i];
+        io_conf.pin_bit_mask |= 1ULL << gpios[i];
+    }
+    gpio_config(&io_conf);
+    struct gpio_bundle *bundle = malloc(sizeof(struct gpio_bundle));
+    if(bundle == NULL){
+        return NULL;
+    }
+    dedic_gpio_bundle_config_t bundle_config = {
+        .gpio_array = gpios,
+        .array_size = config->pin_qty,
         .flags = {
-            .out_en = 1,
+            .in_en = (config->dir != GPIO_BUNDLE_OUTPUT),
+            .out_en = (config->dir != GPIO_BUNDLE_INPUT),
         },
     };
-    ESP_ERROR_CHECK(dedic_gpio_new_bundle(&bundleA_config, &bundleA));
+    if(dedic_gpio_new_bundle(&bundle_config, &bundle->handle) != ESP_OK){
+        free(bundle);
+        return NULL;
+    }
+    bundle->dir = config->dir;
+    /* the inline functions access the CPU registers directly: masks are 0 for an unused direction */
+    uint32_t out_offset = 0, in_offset = 0;
+    bundle->out_mask = 0;
+    bundle->in_mask = 0;
+    if(bundle_config.flags.out_en){
+        dedic_gpio_get_out_mask(bundle->handle, &bundle->out_mask);
+        dedic_gpio_get_out_offset(bundle->handle, &out_offset);
+    }
+    if(bundle_config.flags.in_en){
+        dedic_gpio_get_in_mask(bundle->handle, &bundle->in_mask);
+        dedic_gpio_get_in_offset(bundle->handle, &in_offset);
+    }
+    bundle->out_offset = out_offset;
+    bundle->in_offset = in_offset;
+    return bundle;
 }
 
-void GPIOFastWrite(uint16_t value){
-    dedic_gpio_bundle_write(bundleA, 0xFF, value);
+void GPIOBundleDelete(gpio_bundle_handle_t bundle){
+    if(bundle == NULL){
+        return;
+    }
+    dedic_gpio_del_bundle(bundle->handle);
+    free(bundle);
+}
+
+void GPIOFastInit(gpio_t *pin_list, uint8_t pin_qty){
+    gpio_bundle_config_t config = {
+        .pin_list = pin_list,
+        .pin_qty = pin_qty,
+        .dir = GPIO_BUNDLE_OUTPUT,
+    };
+    GPIOBundleDelete(gpio_fast_bundle);
+    gpio_fast_bundle = GPIOBundleCreate(&config);
+    ESP_ERROR_CHECK((gpio_fast_bundle == NULL) ? ESP_FAIL : ESP_OK);
 }
 
-/*==================[end of file]============================================*/
\ No newline at end of file
+/*==================[end of file]============================================*/
@@ -14,8 +14,13 @@
 #include <stdint.h>
 #include "driver/gpio.h"
 #include "driver/gpio_filter.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
 /*==================[macros and definitions]=================================*/
 #define GPIO_QTY 	24
+#define GPIO_VALID_MASK	(((1UL << GPIO_QTY) - 1) & ~GPIO_MASK(GPIO_14))	/*!< GPIOs handled by this driver */
 #define FILTER_QTY	8
 typedef struct{
 	uint64_t pin;				/*!< GPIO pin */
@@ -59,6 +64,7 @@ gpio_flex_glitch_filter_config_t filter_config = {
 	.window_width_ns = 700,
 	.window_thres_ns = 600,
 };
+static portMUX_TYPE gpio_out_lock = portMUX_INITIALIZER_UNLOCKED;	/*!< Makes GPIOWriteMask() a single output register update */
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
@@ -98,6 +104,19 @@ void GPIOToggle(gpio_t pin){
 	gpio_set_level(gpio_list[pin].pin, gpio_list[pin].state);
 }
 
+void IRAM_ATTR GPIOWriteMask(uint32_t mask, uint32_t values){
+	mask &= GPIO_VALID_MASK;
+	portENTER_CRITICAL_SAFE(&gpio_out_lock);
+	/* every pin in mask changes with the same register write */
+	REG_WRITE(GPIO_OUT_REG, (REG_READ(GPIO_OUT_REG) & ~mask) | (values & mask));
+	portEXIT_CRITICAL_SAFE(&gpio_out_lock);
+	for(uint8_t pin = 0; mask != 0; pin++, mask >>= 1){
+		if(mask & 1){
+			gpio_list[pin].state = (values >> pin) & 1;
+		}
+	}
+}
+
 bool GPIORead(gpio_t pin){
 	return gpio_get_level(gpio_list[pin].pin);
 }
@@ -10,43 +10,344 @@
  */
 
 /*==================[inclusions]=============================================*/
+#include <string.h>
+#include <stdlib.h>
 #include <esp_log.h>
 #include <esp_err.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 //#include "sdkconfig.h"
 
 #include "i2c_mcu.h"
+#include "timer_mcu.h"
 /*==================[macros and definitions]=================================*/
-#define I2C_NUM I2C_NUM_0
+#define I2C_GLITCH_IGNORE_CNT   7           /*!< Glitch filter (in APB clock cycles) */
+#define I2C_TASK_STACK          2048        /*!< I2C task stack (transfer callbacks run on it) */
+#define I2C_TASK_PRIORITY       10          /*!< I2C task priority */
+#define I2C_REGISTERS           256         /*!< Registers of an 8-bit address device */
 
 #undef ESP_ERROR_CHECK
 #define ESP_ERROR_CHECK(x)   do { esp_err_t rc = (x); if (rc != ESP_OK) { ESP_LOGE("err", "esp_err_t = %d", rc); /*assert(0 && #x);*/} } while(0);
 
 /*==================[internal data definition]===============================*/
+/**
+ * @brief Slave device on the bus
+ */
+typedef struct {
+	uint8_t address;						/*!< 7 bits slave address */
+	i2c_master_dev_handle_t handle;			/*!< Driver handle (NULL if a clock change could not add the device again) */
+	uint8_t *cache;							/*!< Shadow registers (NULL if cache is disabled) */
+	uint32_t cache_valid[I2C_REGISTERS / 32];	/*!< Shadow registers holding the device value */
+	uint32_t cache_volatile[I2C_REGISTERS / 32];/*!< Registers never cached */
+	uint32_t clock;							/*!< SCL frequency */
+	i2c_stats_t stats;						/*!< Bus usage counters */
+} i2c_device_t;
+
+static i2c_master_bus_handle_t i2c_bus = NULL;		/*!< Bus handle */
+static uint32_t i2c_clock = I2C_MASTER_FREQ_HZ;		/*!< SCL frequency of the devices */
+static i2c_device_t i2c_devices[I2C_DEVICES_MAX];	/*!< Devices added to the bus */
+static uint8_t i2c_device_qty = 0;					/*!< Number of devices added to the bus */
+static SemaphoreHandle_t i2c_devices_mutex;			/*!< Protects the devices table */
+static StaticSemaphore_t i2c_devices_mutex_buffer;	/*!< Memory of i2c_devices_mutex */
+static QueueHandle_t i2c_queue;						/*!< Transactions queued for the I2C task */
+static SemaphoreHandle_t i2c_submit_mutex;			/*!< Keeps the transactions of a batch together in the queue */
+static StaticSemaphore_t i2c_submit_mutex_buffer;	/*!< Memory of i2c_submit_mutex */
+static SemaphoreHandle_t i2c_transfer_mutex;		/*!< Held while a device handle or its shadow registers are in use (recursive) */
+static StaticSemaphore_t i2c_transfer_mutex_buffer;	/*!< Memory of i2c_transfer_mutex */
+static TaskHandle_t i2c_task_handle = NULL;			/*!< I2C task (created once) */
+static uint64_t i2c_stats_start;					/*!< Time of last stats reset (in us) */
+static portMUX_TYPE i2c_stats_lock = portMUX_INITIALIZER_UNLOCKED;	/*!< Protects the counters */
 
 /*==================[internal functions declaration]=========================*/
 
+/*==================[internal functions definition]==========================*/
+/** Search a slave address in the devices table (must be called with i2c_devices_mutex taken).
+ * @param devAddr I2C slave device address
+ * @return Device (NULL if it was never used)
+ */
+static i2c_device_t * I2C_lookup(uint8_t devAddr) {
+	for (uint8_t i = 0; i < i2c_device_qty; i++) {
+		if (i2c_devices[i].address == devAddr) {
+			return &i2c_devices[i];
+		}
+	}
+	return NULL;
+}
+
+/** Get the device of a slave address, without adding it to the bus.
+ * @param devAddr I2C slave device address
+ * @return Device (NULL if it was never used)
+ */
+static i2c_device_t * I2C_findDevice(uint8_t devAddr) {
+	i2c_device_t *device;
+	if (i2c_devices_mutex == NULL) {
+		return NULL;
+	}
+	xSemaphoreTake(i2c_devices_mutex, portMAX_DELAY);
+	device = I2C_lookup(devAddr);
+	xSemaphoreGive(i2c_devices_mutex);
+	return device;
+}
+
+/** Get the device of a slave address, adding it to the bus on first use.
+ * @param devAddr I2C slave device address
+ * @return Device (NULL if the table is full)
+ */
+static i2c_device_t * I2C_getDevice(uint8_t devAddr) {
+	i2c_device_t *device = NULL;
+	if (i2c_bus == NULL && !I2C_initialize(I2C_MASTER_FREQ_HZ)) {
+		return NULL;
+	}
+	xSemaphoreTake(i2c_devices_mutex, portMAX_DELAY);
+	device = I2C_lookup(devAddr);
+	if (device == NULL && i2c_device_qty < I2C_DEVICES_MAX) {
+		i2c_device_config_t dev_cfg = {
+			.dev_addr_length = I2C_ADDR_BIT_LEN_7,
+			.device_address = devAddr,
+			.scl_speed_hz = i2c_clock,
+		};
+		i2c_master_dev_handle_t handle;
+		if (i2c_master_bus_add_device(i2c_bus, &dev_cfg, &handle) == ESP_OK) {
+			device = &i2c_devices[i2c_device_qty];
+			memset(device, 0, sizeof(i2c_device_t));
+			device->address = devAddr;
+			device->handle = handle;
+			device->clock = i2c_clock;
+			i2c_device_qty++;
+		}
+	}
+	xSemaphoreGive(i2c_devices_mutex);
+	return device;
+}
+
+/** Check if a register can be served from the shadow registers.
+ */
+static bool I2C_cacheHit(i2c_device_t *device, uint8_t regAddr) {
+	uint32_t bit = 1UL << (regAddr % 32);
+	return (device->cache_valid[regAddr / 32] & bit) && !(device->cache_volatile[regAddr / 32] & bit);
+}
+
+/** Store in the shadow registers the values read from or written to the device.
+ */
+static void I2C_cacheUpdate(i2c_device_t *device, uint8_t regAddr, uint8_t length, const uint8_t *data) {
+	if (device->cache == NULL) {
+		return;
+	}
+	for (uint16_t reg = regAddr; reg < regAddr + length && reg < I2C_REGISTERS; reg++) {
+		device->cache[reg] = data[reg - regAddr];
+		device->cache_valid[reg / 32] |= 1UL << (reg % 32);
+	}
+}
+
+/** Mark shadow registers as not holding the device value.
+ */
+static void I2C_cacheClear(i2c_device_t *device, uint8_t regAddr, uint8_t length) {
+	for (uint16_t reg = regAddr; reg < regAddr + length && reg < I2C_REGISTERS; reg++) {
+		device->cache_valid[reg / 32] &= ~(1UL << (reg % 32));
+	}
+}
+
+/** Update the counters of a device after a bus transaction.
+ * @param device Device addressed
+ * @param rc Driver result
+ * @param length Data bytes transferred
+ * @param start Time when the transaction started (in us)
+ */
+static void I2C_count(i2c_device_t *device, esp_err_t rc, uint8_t length, uint64_t start) {
+	uint32_t busy = TimerGetUs() - start;
+	portENTER_CRITICAL(&i2c_stats_lock);
+	device->stats.transactions++;
+	device->stats.busy_us += busy;
+	switch (rc) {
+		case ESP_OK:
+			device->stats.bytes += length;
+			break;
+		case ESP_ERR_TIMEOUT:
+			device->stats.timeouts++;
+			break;
+		case ESP_ERR_INVALID_STATE:
+			/* the driver reports a NACK as an invalid state */
+			device->stats.nacks++;
+			break;
+		default:
+			device->stats.errors++;
+			break;
+	}
+	portEXIT_CRITICAL(&i2c_stats_lock);
+}
+
+/** Do a bus transaction with a device and update its counters.
+ * The handle is used holding i2c_transfer_mutex, so I2C_setClock() can't replace it meanwhile.
+ * @param device Device addressed
+ * @param tx Bytes to write (register address first)
+ * @param tx_length Number of bytes to write
+ * @param rx Buffer for the bytes read after a repeated start (NULL to only write)
+ * @param rx_length Number of bytes to read
+ * @param length Data bytes transferred, for the counters
+ * @param timeout Timeout in milliseconds
+ * @return Driver result
+ */
+static esp_err_t I2C_transfer(i2c_device_t *device, const uint8_t *tx, size_t tx_length, uint8_t *rx, size_t rx_length, uint8_t length, uint16_t timeout) {
+	esp_err_t rc;
+	xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+	if (device->handle == NULL) {
+		/* not on the bus after a failed clock change */
+		xSemaphoreGiveRecursive(i2c_transfer_mutex);
+		return ESP_ERR_INVALID_ARG;
+	}
+	uint64_t start = TimerGetUs();
+	if (rx != NULL) {
+		rc = i2c_master_transmit_receive(device->handle, tx, tx_length, rx, rx_length, timeout);
+	} else {
+		rc = i2c_master_transmit(device->handle, tx, tx_length, timeout);
+	}
+	I2C_count(device, rc, length, start);
+	xSemaphoreGiveRecursive(i2c_transfer_mutex);
+	return rc;
+}
+
+/** Read registers of a device, from the shadow registers when every one is cached.
+ * @param device Device addressed
+ * @param regAddr First register to read from
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ * @param timeout Timeout in milliseconds (0 to use I2C_MASTER_TIMEOUT_MS)
+ * @return Driver result (ESP_OK when served from the cache)
+ */
+static esp_err_t I2C_read(i2c_device_t *device, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout) {
+	esp_err_t rc = ESP_OK;
+	/* cache check, transfer and cache update are one step for the other tasks */
+	xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+	if (device->cache != NULL) {
+		uint16_t reg = regAddr;
+		while (reg < regAddr + length && reg < I2C_REGISTERS && I2C_cacheHit(device, reg)) {
+			reg++;
+		}
+		if (reg == regAddr + length) {
+			memcpy(data, &device->cache[regAddr], length);
+			xSemaphoreGiveRecursive(i2c_transfer_mutex);
+			return ESP_OK;
+		}
+	}
+	/* START, address + W, register, repeated START, address + R, data, STOP */
+	rc = I2C_transfer(device, &regAddr, 1, data, length, length, (timeout != 0) ? timeout : I2C_MASTER_TIMEOUT_MS);
+	ESP_ERROR_CHECK(rc);
+	if (rc == ESP_OK) {
+		I2C_cacheUpdate(device, regAddr, length, data);
+	}
+	xSemaphoreGiveRecursive(i2c_transfer_mutex);
+	return rc;
+}
+
+/** Read-modify-write of some bits of a register, skipped if the cached value doesn't change.
+ * Holds i2c_transfer_mutex, so no other write to the register gets in between.
+ * @param devAddr I2C slave device address
+ * @param regAddr Register address to write to
+ * @param mask Bits to change
+ * @param value New value of the bits in mask (already shifted)
+ * @return Status of operation (true = success)
+ */
+static bool I2C_writeMasked(uint8_t devAddr, uint8_t regAddr, uint8_t mask, uint8_t value) {
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	uint8_t old, b;
+	bool success = true;
+	if (device == NULL) {
+		return false;
+	}
+	xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+	if (I2C_read(device, regAddr, 1, &old, 0) != ESP_OK) {
+		success = false;
+	} else {
+		b = (old & ~mask) | (value & mask);
+		/* with cache the value read is the device value: nothing to write if unchanged */
+		if (b != old || device->cache == NULL) {
+			success = I2C_writeBytes(devAddr, regAddr, 1, &b);
+		}
+	}
+	xSemaphoreGiveRecursive(i2c_transfer_mutex);
+	return success;
+}
+
+/** Run a transaction and call its function.
+ */
+static void I2C_run(const i2c_transaction_t *transaction) {
+	bool success;
+	if (transaction->read) {
+		/* the status, not the byte count: I2C_readBytes() can't return lengths above 127 */
+		i2c_device_t *device = I2C_getDevice(transaction->devAddr);
+		success = (device != NULL) && (I2C_read(device, transaction->regAddr, transaction->length, transaction->data, 0) == ESP_OK);
+	} else {
+		success = I2C_writeBytes(transaction->devAddr, transaction->regAddr, transaction->length, transaction->data);
+	}
+	if (transaction->func_p != NULL) {
+		transaction->func_p(transaction->param_p, success);
+	}
+}
+
+/** Task doing the queued transactions.
+ */
+static void I2C_task(void *pvParameters) {
+	i2c_transaction_t transaction;
+	while (1) {
+		/* wait for the first transaction, then run the queued ones back to back, without
+		 * synchronous transfers in between (at most I2C_QUEUE_SIZE, so they are not starved) */
+		if (xQueueReceive(i2c_queue, &transaction, portMAX_DELAY)) {
+			uint8_t done = 0;
+			xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+			do {
+				I2C_run(&transaction);
+			} while (++done < I2C_QUEUE_SIZE && xQueueReceive(i2c_queue, &transaction, 0));
+			xSemaphoreGiveRecursive(i2c_transfer_mutex);
+		}
+	}
+}
+
 /*==================[external functions definition]==========================*/
 
 /** Initialize I2C0
  */
 bool I2C_initialize( uint32_t clockRateHz )
 {
-	int i2c_master_port = I2C_MASTER_NUM;
-
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = I2C_MASTER_SDA_IO,
-        .scl_io_num = I2C_MASTER_SCL_IO,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = clockRateHz,
-    };
-
-    i2c_param_config(i2c_master_port, &conf);
-
-    return i2c_driver_install(i2c_master_port, conf.mode, I2C_MASTER_RX_BUF_DISABLE, I2C_MASTER_TX_BUF_DISABLE, 0);
+	if (i2c_bus != NULL) {
+		return true;
+	}
+	i2c_master_bus_config_t bus_cfg = {
+		.i2c_port = I2C_MASTER_NUM,
+		.sda_io_num = I2C_MASTER_SDA_IO,
+		.scl_io_num = I2C_MASTER_SCL_IO,
+		.clk_source = I2C_CLK_SRC_DEFAULT,
+		.glitch_ignore_cnt = I2C_GLITCH_IGNORE_CNT,
+		.flags.enable_internal_pullup = true,
+	};
+	i2c_master_bus_handle_t bus;
+	if (i2c_new_master_bus(&bus_cfg, &bus) != ESP_OK) {
+		return false;
+	}
+	/* a failed attempt keeps what was created, a retry only creates what is missing */
+	if (i2c_devices_mutex == NULL) {
+		i2c_devices_mutex = xSemaphoreCreateMutexStatic(&i2c_devices_mutex_buffer);
+	}
+	if (i2c_submit_mutex == NULL) {
+		i2c_submit_mutex = xSemaphoreCreateMutexStatic(&i2c_submit_mutex_buffer);
+	}
+	if (i2c_transfer_mutex == NULL) {
+		i2c_transfer_mutex = xSemaphoreCreateRecursiveMutexStatic(&i2c_transfer_mutex_buffer);
+	}
+	if (i2c_queue == NULL) {
+		i2c_queue = xQueueCreate(I2C_QUEUE_SIZE, sizeof(i2c_transaction_t));
+	}
+	if (i2c_devices_mutex == NULL || i2c_submit_mutex == NULL || i2c_transfer_mutex == NULL || i2c_queue == NULL ||
+		(i2c_task_handle == NULL &&
+		xTaskCreate(I2C_task, "I2C_task", I2C_TASK_STACK, NULL, I2C_TASK_PRIORITY, &i2c_task_handle) != pdPASS)) {
+		i2c_task_handle = NULL;
+		i2c_del_master_bus(bus);
+		return false;
+	}
+	i2c_clock = (clockRateHz > I2C_MASTER_FREQ_MAX) ? I2C_MASTER_FREQ_MAX : clockRateHz;
+	i2c_stats_start = TimerGetUs();
+	i2c_bus = bus;
 	return true;
 };
 
@@ -124,42 +425,25 @@ int8_t I2C_readByte(uint8_t devAddr, uint8_t regAddr, uint8_t *data, uint16_t ti
  * @return I2C_TransferReturn_TypeDef http://downloads.energymicro.com/documentation/doxygen/group__I2C.html
  */
 int8_t I2C_readBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, uint16_t timeout) {
-	i2c_cmd_handle_t cmd;
-	I2C_SelectRegister(devAddr, regAddr);
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_READ, 1));
-
-	if(length>1)
-	ESP_ERROR_CHECK(i2c_master_read(cmd, data, length-1, I2C_MASTER_ACK));
-
-	ESP_ERROR_CHECK(i2c_master_read_byte(cmd, data+length-1, I2C_MASTER_NACK));
-
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_NUM, cmd, 1000/portTICK_PERIOD_MS));
-	i2c_cmd_link_delete(cmd);
-
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	if (device == NULL || I2C_read(device, regAddr, length, data, timeout) != ESP_OK) {
+		return 0;
+	}
 	return length;
 }
 
 bool I2C_writeWord(uint8_t devAddr, uint8_t regAddr, uint16_t data){
 
 	uint8_t data1[] = {(uint8_t)(data>>8), (uint8_t)(data & 0xff)};
-	I2C_writeBytes(devAddr, regAddr, 2, data1);
-	return true;
+	return I2C_writeBytes(devAddr, regAddr, 2, data1);
 }
 
 void I2C_SelectRegister(uint8_t devAddr, uint8_t reg){
-	i2c_cmd_handle_t cmd;
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, reg, 1));
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_NUM, cmd, 1000/portTICK_PERIOD_MS));
-	i2c_cmd_link_delete(cmd);
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	if (device != NULL) {
+		esp_err_t rc = I2C_transfer(device, &reg, 1, NULL, 0, 0, I2C_MASTER_TIMEOUT_MS);
+		ESP_ERROR_CHECK(rc);
+	}
 }
 
 /** write a single bit in an 8-bit device register.
@@ -170,10 +454,7 @@ void I2C_SelectRegister(uint8_t devAddr, uint8_t reg){
  * @return Status of operation (true = success)
  */
 bool I2C_writeBit(uint8_t devAddr, uint8_t regAddr, uint8_t bitNum, uint8_t data) {
-    uint8_t b;
-    I2C_readByte(devAddr, regAddr, &b, 0);
-    b = (data != 0) ? (b | (1 << bitNum)) : (b & ~(1 << bitNum));
-    return I2C_writeByte(devAddr, regAddr, b);
+    return I2C_writeMasked(devAddr, regAddr, 1 << bitNum, (data != 0) ? 0xFF : 0);
 }
 
 /** Write multiple bits in an 8-bit device register.
@@ -192,17 +473,9 @@ bool I2C_writeBits(uint8_t devAddr, uint8_t regAddr, uint8_t bitStart, uint8_t l
     // 10101111 original value (sample)
     // 10100011 original & ~mask
     // 10101011 masked | value
-    uint8_t b = 0;
-    if (I2C_readByte(devAddr, regAddr, &b, 0) != 0) {
-        uint8_t mask = ((1 << length) - 1) << (bitStart - length + 1);
-        data <<= (bitStart - length + 1); // shift data into correct position
-        data &= mask; // zero all non-important bits in data
-        b &= ~(mask); // zero all important bits in existing byte
-        b |= data; // combine data with existing byte
-        return I2C_writeByte(devAddr, regAddr, b);
-    } else {
-        return false;
-    }
+    uint8_t mask = ((1 << length) - 1) << (bitStart - length + 1);
+    data <<= (bitStart - length + 1); // shift data into correct position
+    return I2C_writeMasked(devAddr, regAddr, mask, data);
 }
 
 /** Write single byte to an 8-bit device register.
@@ -212,18 +485,7 @@ bool I2C_writeBits(uint8_t devAddr, uint8_t regAddr, uint8_t bitStart, uint8_t l
  * @return Status of operation (true = success)
  */
 bool I2C_writeByte(uint8_t devAddr, uint8_t regAddr, uint8_t data) {
-	i2c_cmd_handle_t cmd;
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, regAddr, 1));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, data, 1));
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_NUM, cmd, 1000/portTICK_PERIOD_MS));
-	i2c_cmd_link_delete(cmd);
-
-	return true;
+	return I2C_writeBytes(devAddr, regAddr, 1, &data);
 }
 
 /** Write single byte to an 8-bit device register.
@@ -234,20 +496,179 @@ bool I2C_writeByte(uint8_t devAddr, uint8_t regAddr, uint8_t data) {
  * @return Status of operation (true = success)
  */
 bool I2C_writeBytes(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data){
-	i2c_cmd_handle_t cmd;
-
-	cmd = i2c_cmd_link_create();
-	ESP_ERROR_CHECK(i2c_master_start(cmd));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (devAddr << 1) | I2C_MASTER_WRITE, 1));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, regAddr, 1));
-	ESP_ERROR_CHECK(i2c_master_write(cmd, data, length-1, 0));
-	ESP_ERROR_CHECK(i2c_master_write_byte(cmd, data[length-1], 1));
-	ESP_ERROR_CHECK(i2c_master_stop(cmd));
-	i2c_master_cmd_begin(I2C_NUM, cmd, 1000/portTICK_PERIOD_MS);
-	i2c_cmd_link_delete(cmd);
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	uint8_t buffer[length + 1];
+	if (device == NULL) {
+		return false;
+	}
+	buffer[0] = regAddr;
+	memcpy(&buffer[1], data, length);
+	/* the shadow registers follow the writes in the order they reach the device */
+	xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+	esp_err_t rc = I2C_transfer(device, buffer, (size_t)length + 1, NULL, 0, length, I2C_MASTER_TIMEOUT_MS);
+	ESP_ERROR_CHECK(rc);
+	if (rc != ESP_OK) {
+		/* the device may hold any value now */
+		I2C_cacheClear(device, regAddr, length);
+	} else {
+		I2C_cacheUpdate(device, regAddr, length, data);
+	}
+	xSemaphoreGiveRecursive(i2c_transfer_mutex);
+	return (rc == ESP_OK);
+}
+
+bool I2C_readBytesAsync(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, i2c_callback_t func_p, void *param_p){
+	i2c_transaction_t transaction = {
+		.devAddr = devAddr,
+		.regAddr = regAddr,
+		.length = length,
+		.read = true,
+		.data = data,
+		.func_p = func_p,
+		.param_p = param_p,
+	};
+	return I2C_submit(&transaction, 1);
+}
+
+bool I2C_writeBytesAsync(uint8_t devAddr, uint8_t regAddr, uint8_t length, uint8_t *data, i2c_callback_t func_p, void *param_p){
+	i2c_transaction_t transaction = {
+		.devAddr = devAddr,
+		.regAddr = regAddr,
+		.length = length,
+		.read = false,
+		.data = data,
+		.func_p = func_p,
+		.param_p = param_p,
+	};
+	return I2C_submit(&transaction, 1);
+}
+
+bool I2C_submit(const i2c_transaction_t *transactions, uint8_t qty){
+	bool queued = false;
+	if (i2c_bus == NULL && !I2C_initialize(I2C_MASTER_FREQ_HZ)) {
+		return false;
+	}
+	xSemaphoreTake(i2c_submit_mutex, portMAX_DELAY);
+	if (uxQueueSpacesAvailable(i2c_queue) >= qty) {
+		for (uint8_t i = 0; i < qty; i++) {
+			xQueueSend(i2c_queue, &transactions[i], 0);
+		}
+		queued = true;
+	}
+	xSemaphoreGive(i2c_submit_mutex);
+	return queued;
+}
+
+bool I2C_setClock(uint8_t devAddr, uint32_t clockRateHz){
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	bool success = false;
+	if (device == NULL) {
+		return false;
+	}
+	if (clockRateHz > I2C_MASTER_FREQ_MAX) {
+		clockRateHz = I2C_MASTER_FREQ_MAX;
+	}
+	i2c_device_config_t dev_cfg = {
+		.dev_addr_length = I2C_ADDR_BIT_LEN_7,
+		.device_address = devAddr,
+		.scl_speed_hz = clockRateHz,
+	};
+	i2c_master_dev_handle_t handle;
+	/* no transfer uses the handle while it is replaced */
+	xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+	/* the driver can't change the clock of a device: it is added again */
+	if (device->handle != NULL && i2c_master_bus_rm_device(device->handle) != ESP_OK) {
+		/* the old handle is still valid */
+		xSemaphoreGiveRecursive(i2c_transfer_mutex);
+		return false;
+	}
+	device->handle = NULL;
+	if (i2c_master_bus_add_device(i2c_bus, &dev_cfg, &handle) == ESP_OK) {
+		device->clock = clockRateHz;
+		success = true;
+	} else {
+		/* try to restore the previous clock, the device is unusable (NULL handle) if that fails too */
+		dev_cfg.scl_speed_hz = device->clock;
+		if (i2c_master_bus_add_device(i2c_bus, &dev_cfg, &handle) != ESP_OK) {
+			handle = NULL;
+		}
+	}
+	device->handle = handle;
+	xSemaphoreGiveRecursive(i2c_transfer_mutex);
+	return success;
+}
+
+bool I2C_getStats(uint8_t devAddr, i2c_stats_t *stats){
+	i2c_device_t *device = I2C_findDevice(devAddr);
+	if (device == NULL) {
+		return false;
+	}
+	uint64_t elapsed = TimerGetUs() - i2c_stats_start;
+	portENTER_CRITICAL(&i2c_stats_lock);
+	*stats = device->stats;
+	portEXIT_CRITICAL(&i2c_stats_lock);
+	stats->occupancy = (elapsed > 0) ? stats->busy_us * 100 / elapsed : 0;
 	return true;
 }
 
+void I2C_resetStats(void){
+	portENTER_CRITICAL(&i2c_stats_lock);
+	for (uint8_t i = 0; i < i2c_device_qty; i++) {
+		memset(&i2c_devices[i].stats, 0, sizeof(i2c_stats_t));
+	}
+	i2c_stats_start = TimerGetUs();
+	portEXIT_CRITICAL(&i2c_stats_lock);
+}
+
+bool I2C_cacheEnable(uint8_t devAddr){
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	if (device == NULL) {
+		return false;
+	}
+	xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+	if (device->cache == NULL) {
+		memset(device->cache_valid, 0, sizeof(device->cache_valid));
+		device->cache = malloc(I2C_REGISTERS);
+	}
+	xSemaphoreGiveRecursive(i2c_transfer_mutex);
+	return (device->cache != NULL);
+}
+
+bool I2C_cacheEnabled(uint8_t devAddr){
+	i2c_device_t *device = I2C_findDevice(devAddr);
+	return (device != NULL && device->cache != NULL);
+}
+
+void I2C_cacheSetVolatile(uint8_t devAddr, uint8_t regAddr, uint8_t length){
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	if (device == NULL) {
+		return;
+	}
+	xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+	for (uint16_t reg = regAddr; reg < regAddr + length && reg < I2C_REGISTERS; reg++) {
+		device->cache_volatile[reg / 32] |= 1UL << (reg % 32);
+	}
+	xSemaphoreGiveRecursive(i2c_transfer_mutex);
+}
+
+void I2C_cacheInvalidate(uint8_t devAddr, uint8_t regAddr, uint8_t length){
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	if (device == NULL) {
+		return;
+	}
+	xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+	I2C_cacheClear(device, regAddr, length);
+	xSemaphoreGiveRecursive(i2c_transfer_mutex);
+}
+
+void I2C_cacheInvalidateAll(uint8_t devAddr){
+	i2c_device_t *device = I2C_getDevice(devAddr);
+	if (device != NULL) {
+		xSemaphoreTakeRecursive(i2c_transfer_mutex, portMAX_DELAY);
+		memset(device->cache_valid, 0, sizeof(device->cache_valid));
+		xSemaphoreGiveRecursive(i2c_transfer_mutex);
+	}
+}
 
 /**
  * read word
@@ -15,6 +15,9 @@
 #include <string.h>
 #include "driver/spi_master.h"
 #include "gpio_mcu.h"
+#include "timer_mcu.h"
+#include "dma_pool_mcu.h"
+#include "freertos/FreeRTOS.h"
 /*==================[macros and definitions]=================================*/
 #define PIN_NUM_MISO	GPIO_22	/*!<  */
 #define PIN_NUM_MOSI	GPIO_21	/*!<  */
@@ -22,9 +25,32 @@
 #define PIN_NUM_CS1		GPIO_19	/*!<  */
 #define PIN_NUM_CS2		GPIO_18	/*!<  */
 #define PIN_NUM_CS3		GPIO_9	/*!<  */
+#define SPI_DEVICES		3		/*!< Number of chip select pins */
 /*==================[internal data declaration]==============================*/
-spi_device_handle_t spi_1, spi_2, spi_3;
-const spi_bus_config_t bus_cfg = {
+/**
+ * @brief State of a device on the SPI bus
+ */
+typedef struct {
+    spi_device_handle_t handle;                 /*!< Driver handle (NULL if not added to the bus) */
+    transfer_mode_t transfer_mode;              /*!< Transfer mode */
+    clk_mode_t clk_mode;                        /*!< Mode used to add the device */
+    uint32_t bitrate;                           /*!< Bitrate used to add the device */
+    void (*func_p)(void*);                      /*!< Transaction end callback */
+    void *param_p;                              /*!< Transaction end callback parameter */
+    spi_transaction_t trans[SPI_QUEUE_SIZE];    /*!< Queued transactions (ring) */
+    uint8_t trans_head;                         /*!< Next free transaction */
+    uint8_t in_flight;                          /*!< Transactions queued and not yet returned */
+    uint8_t *batch;                             /*!< Small writes merged into a single transaction (from the DMA pool) */
+    uint16_t batch_length;                      /*!< Bytes waiting in batch */
+    uint32_t trans_start;                       /*!< Cycle count at the start of the current transaction */
+    uint32_t transactions;                      /*!< Transactions finished since last stats reset */
+    uint64_t bytes;                             /*!< Bytes transferred since last stats reset */
+    uint64_t busy_cycles;                       /*!< Bus cycles used since last stats reset */
+} spi_device_data_t;
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static const spi_bus_config_t bus_cfg = {
     .miso_io_num = PIN_NUM_MISO,
     .mosi_io_num = PIN_NUM_MOSI,
     .sclk_io_num = PIN_NUM_CLK,
@@ -32,73 +58,107 @@ const spi_bus_config_t bus_cfg = {
     .quadhd_io_num = -1,
     .max_transfer_sz = 4092
 };
-transfer_mode_t transfer_mode_1, transfer_mode_2, transfer_mode_3;
-void (*spi_1_isr_p)(void*);	/*!<  */
-void (*spi_2_isr_p)(void*);	/*!<  */
-void (*spi_3_isr_p)(void*);	/*!<  */
-void *spi_1_user_data;	    /*!<  */
-void *spi_2_user_data;	    /*!<  */
-void *spi_3_user_data;	    /*!<  */
-/*==================[internal functions declaration]=========================*/
-static void IRAM_ATTR spi_1_isr(spi_transaction_t *t){
-	spi_1_isr_p(spi_1_user_data);
+static const gpio_t cs_pins[SPI_DEVICES] = {PIN_NUM_CS1, PIN_NUM_CS2, PIN_NUM_CS3};   /*!< CS pin of each device */
+static spi_device_data_t spi_devices[SPI_DEVICES];                                  /*!< Devices state */
+static uint64_t stats_start;                                                        /*!< Time of last stats reset (in us) */
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;                      /*!< Protects the stats updated in ISR */
+static bool spi_initialized = false;                                                /*!< Bus initialized (on the first SpiInit()) */
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void IRAM_ATTR spi_pre_isr(spi_transaction_t *t){
+    spi_device_data_t *dev = t->user;
+    dev->trans_start = TimerGetCycles32();
 }
-static void IRAM_ATTR spi_2_isr(spi_transaction_t *t){
-	spi_2_isr_p(spi_2_user_data);
+
+static void IRAM_ATTR spi_post_isr(spi_transaction_t *t){
+    spi_device_data_t *dev = t->user;
+    uint32_t cycles = TimerGetCycles32() - dev->trans_start;
+    portENTER_CRITICAL_SAFE(&stats_lock);
+    dev->transactions++;
+    dev->bytes += t->length / 8;
+    dev->busy_cycles += cycles;
+    portEXIT_CRITICAL_SAFE(&stats_lock);
+    if(dev->transfer_mode == SPI_INTERRUPT && dev->func_p != NULL){
+        dev->func_p(dev->param_p);
+    }
 }
-static void IRAM_ATTR spi_3_isr(spi_transaction_t *t){
-	spi_3_isr_p(spi_3_user_data);
+
+/**
+ * @brief Blocking transaction: waits for queued transactions of the device and sends t
+ */
+static void SpiSend(spi_device_data_t *dev, spi_transaction_t *t){
+    spi_dev_t device = dev - spi_devices;
+    SpiWaitAll(device);
+    t->user = dev;
+    switch(dev->transfer_mode){
+        case SPI_POLLING:
+            spi_device_polling_transmit(dev->handle, t);
+            break;
+        case SPI_INTERRUPT:
+            spi_device_transmit(dev->handle, t);
+            break;
+    }
 }
-/*==================[internal data definition]===============================*/
 
-/*==================[external data definition]===============================*/
+/**
+ * @brief Send the merged small writes of a device as a single transaction
+ */
+static void SpiBatchSend(spi_device_data_t *dev){
+    spi_transaction_t t;
+    if(dev->batch_length == 0){
+        return;
+    }
+    memset(&t, 0, sizeof(t));
+    t.length = dev->batch_length * 8;
+    t.tx_buffer = dev->batch;
+    dev->batch_length = 0;
+    SpiSend(dev, &t);
+}
 
-/*==================[internal functions definition]==========================*/
+static void SpiTransmit(spi_dev_t device, spi_transaction_t *t){
+    SpiBatchSend(&spi_devices[device]);
+    SpiSend(&spi_devices[device], t);
+}
 
+static void SpiStatsFill(spi_stats_t *stats, uint32_t transactions, uint64_t bytes, uint64_t busy_cycles){
+    uint64_t elapsed = TimerGetUs() - stats_start;
+    stats->transactions = transactions;
+    stats->bytes = bytes;
+    stats->bytes_per_s = (elapsed > 0) ? bytes * 1000000 / elapsed : 0;
+    stats->busy = (elapsed > 0) ? TimerCyclesToUs(busy_cycles) * 100 / elapsed : 0;
+}
 /*==================[external functions definition]==========================*/
 uint8_t SpiInit(spi_mcu_config_t* spi){
-    static bool spi_initialized = false;
+    spi_device_data_t *dev = &spi_devices[spi->device];
     if(!spi_initialized){
 	    spi_bus_initialize(SPI2_HOST, &bus_cfg, SPI_DMA_CH_AUTO);
+        DmaPoolInit();
+        stats_start = TimerGetUs();
         spi_initialized = true;
+    }
+    if(dev->handle != NULL){
+        if(dev->clk_mode == spi->clk_mode && dev->bitrate == spi->bitrate && dev->transfer_mode == spi->transfer_mode 
+            && dev->func_p == spi->func_p && dev->param_p == spi->param_p){
+            // already added with the same configuration
+            return 0;
+        }
+        SpiDeInit(spi->device);
     }
 	spi_device_interface_config_t dev_cfg = {
         .clock_speed_hz = spi->bitrate,     	
         .mode = spi->clk_mode,                  
-        .queue_size = 8,                        
+        .spics_io_num = cs_pins[spi->device],
+        .queue_size = SPI_QUEUE_SIZE,                        
+        .pre_cb = spi_pre_isr,
+        .post_cb = spi_post_isr,
     };
-    switch(spi->device){
-        case SPI_1:
-            dev_cfg.spics_io_num = PIN_NUM_CS1;
-            transfer_mode_1 = spi->transfer_mode;
-            if(transfer_mode_1 == SPI_INTERRUPT){
-                dev_cfg.post_cb = spi_1_isr;
-            } 
-            spi_bus_add_device(SPI2_HOST, &dev_cfg, &spi_1);
-            spi_1_isr_p = spi->func_p;
-            spi_1_user_data = spi->param_p;
-            break;
-        case SPI_2:
-            dev_cfg.spics_io_num = PIN_NUM_CS2;
-            if(transfer_mode_2 == SPI_INTERRUPT){
-                dev_cfg.post_cb = spi_2_isr;
-            } 
-            transfer_mode_1 = spi->transfer_mode;
-            spi_bus_add_device(SPI2_HOST, &dev_cfg, &spi_2);
-            spi_2_isr_p = spi->func_p;
-            spi_2_user_data = spi->param_p;
-            break;
-        case SPI_3:
-            dev_cfg.spics_io_num = PIN_NUM_CS3;
-            if(transfer_mode_3 == SPI_INTERRUPT){
-                dev_cfg.post_cb = spi_3_isr;
-            } 
-            transfer_mode_1 = spi->transfer_mode;
-            spi_bus_add_device(SPI2_HOST, &dev_cfg, &spi_3);
-            spi_3_isr_p = spi->func_p;
-            spi_3_user_data = spi->param_p;
-            break;
-    }
+    dev->transfer_mode = spi->transfer_mode;
+    dev->clk_mode = spi->clk_mode;
+    dev->bitrate = spi->bitrate;
+    dev->func_p = spi->func_p;
+    dev->param_p = spi->param_p;
+    spi_bus_add_device(SPI2_HOST, &dev_cfg, &dev->handle);
     return 0;
 }
 
@@ -108,38 +168,7 @@ void SpiRead(spi_dev_t device, uint8_t * rx_buffer, uint32_t rx_buffer_size){
     t.length = rx_buffer_size * 8;  // tx_buffer_size is in bytes, transaction length is in bits.
     t.rxlength = rx_buffer_size * 8;
     t.rx_buffer = rx_buffer;        // Data
-    switch(device){
-        case SPI_1:
-            switch(transfer_mode_1){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_1, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_1, &t); 
-                    break;
-            }
-            break;
-        case SPI_2:
-            switch(transfer_mode_2){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_2, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_2, &t); 
-                    break;
-            }
-            break;
-        case SPI_3:
-            switch(transfer_mode_3){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_3, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_3, &t); 
-                    break;
-            }
-            break;
-    }
+    SpiTransmit(device, &t);
 }
 
 void SpiWrite(spi_dev_t device, uint8_t * tx_buffer, uint32_t tx_buffer_size){
@@ -147,38 +176,7 @@ void SpiWrite(spi_dev_t device, uint8_t * tx_buffer, uint32_t tx_buffer_size){
     memset(&t, 0, sizeof(t));       // Zero out the transaction
     t.length = tx_buffer_size * 8;  // tx_buffer_size is in bytes, transaction length is in bits.
     t.tx_buffer = tx_buffer;        // Data
-    switch(device){
-        case SPI_1:
-            switch(transfer_mode_1){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_1, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_1, &t); 
-                    break;
-            }
-            break;
-        case SPI_2:
-            switch(transfer_mode_2){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_2, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_2, &t); 
-                    break;
-            }
-            break;
-        case SPI_3:
-            switch(transfer_mode_3){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_3, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_3, &t); 
-                    break;
-            }
-            break;
-    }
+    SpiTransmit(device, &t);
 }
 
 void SpiReadWrite(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size){
@@ -188,41 +186,138 @@ void SpiReadWrite(spi_dev_t device, uint8_t * tx_buffer, uint8_t * rx_buffer, ui
     t.rxlength = buffer_size * 8;
     t.tx_buffer = tx_buffer;        // Data
     t.rx_buffer = rx_buffer;        
-    switch(device){
-        case SPI_1:
-            switch(transfer_mode_1){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_1, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_1, &t); 
-                    break;
-            }
-            break;
-        case SPI_2:
-            switch(transfer_mode_2){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_2, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_2, &t); 
-                    break;
-            }
-            break;
-        case SPI_3:
-            switch(transfer_mode_3){
-                case SPI_POLLING:
-                    spi_device_polling_transmit(spi_3, &t); 
-                    break;
-                case SPI_INTERRUPT:
-                    spi_device_transmit(spi_3, &t); 
-                    break;
-            }
-            break;
+    SpiTransmit(device, &t);
+}
+
+bool SpiQueueTransfer(spi_dev_t device, const uint8_t * tx_buffer, uint8_t * rx_buffer, uint32_t buffer_size){
+    spi_device_data_t *dev = &spi_devices[device];
+    if(dev->in_flight == SPI_QUEUE_SIZE){
+        // every transaction is in use: wait for the oldest one
+        SpiWaitTransfer(device, SPI_WAIT_FOREVER);
+    }
+    SpiBatchSend(dev);
+    spi_transaction_t *t = &dev->trans[dev->trans_head];
+    memset(t, 0, sizeof(spi_transaction_t));
+    t->length = buffer_size * 8;
+    t->rxlength = (rx_buffer != NULL) ? buffer_size * 8 : 0;
+    t->tx_buffer = tx_buffer;
+    t->rx_buffer = rx_buffer;
+    t->user = dev;
+    if(spi_device_queue_trans(dev->handle, t, portMAX_DELAY) != ESP_OK){
+        return false;
+    }
+    dev->trans_head = (dev->trans_head + 1) % SPI_QUEUE_SIZE;
+    dev->in_flight++;
+    return true;
+}
+
+bool SpiWaitTransfer(spi_dev_t device, uint32_t timeout){
+    spi_device_data_t *dev = &spi_devices[device];
+    spi_transaction_t *t;
+    if(dev->in_flight == 0){
+        return true;
+    }
+    if(spi_device_get_trans_result(dev->handle, &t, (timeout == SPI_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout)) != ESP_OK){
+        return false;
+    }
+    dev->in_flight--;
+    return true;
+}
+
+void SpiWaitAll(spi_dev_t device){
+    while(spi_devices[device].in_flight > 0){
+        SpiWaitTransfer(device, SPI_WAIT_FOREVER);
+    }
+}
+
+uint8_t SpiPending(spi_dev_t device){
+    return spi_devices[device].in_flight;
+}
+
+void SpiWriteBatched(spi_dev_t device, const uint8_t * tx_buffer, uint32_t tx_buffer_size){
+    spi_device_data_t *dev = &spi_devices[device];
+    if(dev->batch == NULL){
+        dev->batch = DmaPoolAlloc(SPI_BATCH_SIZE);
+        if(dev->batch == NULL){
+            // no buffer available: send without merging
+            SpiWrite(device, (uint8_t *)tx_buffer, tx_buffer_size);
+            return;
+        }
     }
+    if(dev->batch_length + tx_buffer_size > SPI_BATCH_SIZE){
+        SpiBatchSend(dev);
+    }
+    if(tx_buffer_size > SPI_BATCH_SIZE){
+        SpiWrite(device, (uint8_t *)tx_buffer, tx_buffer_size);
+        return;
+    }
+    memcpy(&dev->batch[dev->batch_length], tx_buffer, tx_buffer_size);
+    dev->batch_length += tx_buffer_size;
+}
+
+void SpiFlush(spi_dev_t device){
+    SpiBatchSend(&spi_devices[device]);
+}
+
+bool SpiAcquireBus(spi_dev_t device, uint32_t timeout){
+    return (spi_device_acquire_bus(spi_devices[device].handle, 
+        (timeout == SPI_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout)) == ESP_OK);
+}
+
+void SpiReleaseBus(spi_dev_t device){
+    SpiFlush(device);
+    SpiWaitAll(device);
+    spi_device_release_bus(spi_devices[device].handle);
+}
+
+void SpiGetStats(spi_dev_t device, spi_stats_t *stats){
+    spi_device_data_t *dev = &spi_devices[device];
+    portENTER_CRITICAL(&stats_lock);
+    uint32_t transactions = dev->transactions;
+    uint64_t bytes = dev->bytes;
+    uint64_t busy_cycles = dev->busy_cycles;
+    portEXIT_CRITICAL(&stats_lock);
+    SpiStatsFill(stats, transactions, bytes, busy_cycles);
+}
+
+void SpiGetBusStats(spi_stats_t *stats){
+    uint32_t transactions = 0;
+    uint64_t bytes = 0, busy_cycles = 0;
+    portENTER_CRITICAL(&stats_lock);
+    for(uint8_t i = 0; i < SPI_DEVICES; i++){
+        transactions += spi_devices[i].transactions;
+        bytes += spi_devices[i].bytes;
+        busy_cycles += spi_devices[i].busy_cycles;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    SpiStatsFill(stats, transactions, bytes, busy_cycles);
+}
+
+void SpiResetStats(void){
+    portENTER_CRITICAL(&stats_lock);
+    for(uint8_t i = 0; i < SPI_DEVICES; i++){
+        spi_devices[i].transactions = 0;
+        spi_devices[i].bytes = 0;
+        spi_devices[i].busy_cycles = 0;
+    }
+    stats_start = TimerGetUs();
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+bool SpiBusInitialized(void){
+    return spi_initialized;
 }
 
 uint8_t SpiDeInit(spi_dev_t device){
+    spi_device_data_t *dev = &spi_devices[device];
+    if(dev->handle != NULL){
+        SpiFlush(device);
+        SpiWaitAll(device);
+        spi_bus_remove_device(dev->handle);
+        dev->handle = NULL;
+        DmaPoolFree(dev->batch);
+        dev->batch = NULL;
+    }
     return 0;
 }
 
@@ -0,0 +1,182 @@
+/**
+ * @file telemetry_mcu.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include "telemetry_mcu.h"
+#include <string.h>
+/*==================[macros and definitions]=================================*/
+#define CRC_INIT			0xFFFF		/*!< CRC-16/CCITT-FALSE initial value */
+#define COBS_BLOCK_MAX		0xFF		/*!< Maximum COBS code (254 data bytes) */
+#define FRAME_DELIMITER		0x00
+#define TX_BUFFER_SIZE		(TELEMETRY_COBS_MAX(TELEMETRY_FRAME_MAX) + 2)	/*!< Encoded frame and both delimiters */
+/*==================[internal data declaration]==============================*/
+telemetry_config_t telemetry_config;		/*!< Telemetry configuration */
+uint16_t telemetry_sequence = 0;			/*!< Number of the next frame */
+uint16_t telemetry_index = 0;				/*!< Samples per channel stored in the current frame */
+uint32_t telemetry_dropped = 0;				/*!< Frames dropped since init */
+static uint8_t telemetry_raw[TELEMETRY_FRAME_MAX];	/*!< Frame being filled */
+static uint8_t telemetry_tx[TX_BUFFER_SIZE];		/*!< Encoded frame */
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+static const uint16_t crc_table[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void TelemetryPutU16(uint8_t *dst, uint16_t value){
+	dst[0] = value & 0xFF;
+	dst[1] = value >> 8;
+}
+
+static uint16_t TelemetryGetU16(const uint8_t *src){
+	return src[0] | (src[1] << 8);
+}
+
+/**
+ * @brief Complete the header and CRC of telemetry_raw, encode it and queue it for transmission
+ * 
+ * @param length Samples per channel in the frame
+ * @return false if the frame was dropped
+ */
+static bool TelemetrySendFrame(uint16_t length){
+	uint16_t payload = 2 * telemetry_config.channel_qty * length;
+	uint16_t size = TELEMETRY_HEADER_SIZE + payload;
+	TelemetryPutU16(&telemetry_raw[0], telemetry_sequence++);
+	telemetry_raw[2] = telemetry_config.channel_qty;
+	TelemetryPutU16(&telemetry_raw[3], length);
+	TelemetryPutU16(&telemetry_raw[size], TelemetryCrc16(telemetry_raw, size));
+	size += TELEMETRY_CRC_SIZE;
+	// leading delimiter discards any partial frame left in the receiver
+	uint16_t tx_size = 0;
+	telemetry_tx[tx_size++] = FRAME_DELIMITER;
+	tx_size += TelemetryCobsEncode(telemetry_raw, size, &telemetry_tx[tx_size]);
+	telemetry_tx[tx_size++] = FRAME_DELIMITER;
+	// a truncated frame would be lost anyway and make the receiver resynchronize on it
+	if(!UartSendFrameAsync(telemetry_config.port, (const char*)telemetry_tx, tx_size)){
+		telemetry_dropped++;
+		return false;
+	}
+	return true;
+}
+
+/*==================[external functions definition]==========================*/
+void TelemetryInit(telemetry_config_t *config){
+	telemetry_config = *config;
+	if(telemetry_config.channel_qty > TELEMETRY_CH_MAX){
+		telemetry_config.channel_qty = TELEMETRY_CH_MAX;
+	}
+	if(2 * telemetry_config.channel_qty * telemetry_config.batch > TELEMETRY_PAYLOAD_MAX){
+		telemetry_config.batch = TELEMETRY_PAYLOAD_MAX / (2 * telemetry_config.channel_qty);
+	}
+	telemetry_sequence = 0;
+	telemetry_index = 0;
+	telemetry_dropped = 0;
+}
+
+bool TelemetryPush(const int16_t *samples){
+	for(uint8_t ch = 0; ch < telemetry_config.channel_qty; ch++){
+		TelemetryPutU16(&telemetry_raw[TELEMETRY_HEADER_SIZE + 2 * (ch * telemetry_config.batch + telemetry_index)], samples[ch]);
+	}
+	if(++telemetry_index < telemetry_config.batch){
+		return true;
+	}
+	telemetry_index = 0;
+	return TelemetrySendFrame(telemetry_config.batch);
+}
+
+bool TelemetrySendBlocks(const int16_t *blocks[], uint16_t length){
+	if(2 * telemetry_config.channel_qty * length > TELEMETRY_PAYLOAD_MAX){
+		length = TELEMETRY_PAYLOAD_MAX / (2 * telemetry_config.channel_qty);
+	}
+	uint8_t *dst = &telemetry_raw[TELEMETRY_HEADER_SIZE];
+	for(uint8_t ch = 0; ch < telemetry_config.channel_qty; ch++){
+		for(uint16_t i = 0; i < length; i++){
+			TelemetryPutU16(dst, blocks[ch][i]);
+			dst += 2;
+		}
+	}
+	// samples pushed before are discarded
+	telemetry_index = 0;
+	return TelemetrySendFrame(length);
+}
+
+uint32_t TelemetryDropped(void){
+	return telemetry_dropped;
+}
+
+uint16_t TelemetryCrc16(const uint8_t *data, uint16_t length){
+	uint16_t crc = CRC_INIT;
+	while(length--){
+		crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (*data >> 4)];
+		crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (*data & 0x0F)];
+		data++;
+	}
+	return crc;
+}
+
+uint16_t TelemetryCobsEncode(const uint8_t *src, uint16_t length, uint8_t *dst){
+	uint16_t code_index = 0;
+	uint16_t out = 1;
+	uint8_t code = 1;
+	for(uint16_t i = 0; i < length; i++){
+		if(src[i] != 0){
+			dst[out++] = src[i];
+			code++;
+		}
+		if((src[i] == 0) || (code == COBS_BLOCK_MAX)){
+			dst[code_index] = code;
+			code_index = out++;
+			code = 1;
+		}
+	}
+	dst[code_index] = code;
+	return out;
+}
+
+uint16_t TelemetryCobsDecode(const uint8_t *src, uint16_t length, uint8_t *dst){
+	uint16_t in = 0;
+	uint16_t out = 0;
+	while(in < length){
+		uint8_t code = src[in++];
+		if((code == 0) || (in + code - 1 > length)){
+			return 0;
+		}
+		for(uint8_t i = 1; i < code; i++){
+			dst[out++] = src[in++];
+		}
+		// a zero follows every block except the last and the full ones
+		if((code < COBS_BLOCK_MAX) && (in < length)){
+			dst[out++] = 0;
+		}
+	}
+	return out;
+}
+
+bool TelemetryDecode(uint8_t *src, uint16_t length, telemetry_frame_t *frame){
+	uint16_t size = TelemetryCobsDecode(src, length, src);
+	if(size < TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE){
+		return false;
+	}
+	size -= TELEMETRY_CRC_SIZE;
+	if(TelemetryCrc16(src, size) != TelemetryGetU16(&src[size])){
+		return false;
+	}
+	frame->sequence = TelemetryGetU16(&src[0]);
+	frame->channel_qty = src[2];
+	frame->length = TelemetryGetU16(&src[3]);
+	frame->payload = &src[TELEMETRY_HEADER_SIZE];
+	return (size == TELEMETRY_HEADER_SIZE + 2 * frame->channel_qty * frame->length);
+}
+
+/*==================[end of file]============================================*/
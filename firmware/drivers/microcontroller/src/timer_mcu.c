@@ -11,16 +11,33 @@
 
 /*==================[inclusions]=============================================*/
 #include "timer_mcu.h"
+#include <stdlib.h>
+#include <string.h>
 #include "driver/gptimer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 /*==================[macros and definitions]=================================*/
 #define US_RESOLUTION_HZ	1000000	/*!< 1usec */
 #define RESET_COUNT_VALUE	0		/*!< Reset timer count to 0 */
+#define HEAP_SIZE_INIT		8		/*!< Initial capacity of the deadline heap */
+#define NOT_ARMED			-1		/*!< Heap index of a disarmed timer */
+#define LEGACY_TIMER_QTY	3		/*!< TIMER_A, TIMER_B and TIMER_C */
+#define CYCLES_WRAP_CHECKS	4		/*!< Cycle counter reads per wrap period */
 /*==================[internal data declaration]==============================*/
-gptimer_handle_t timer_a = NULL;	/*!< Handle for timer A */	
-gptimer_handle_t timer_b = NULL;	/*!< Handle for timer B */			
-gptimer_handle_t timer_c = NULL;	/*!< Handle for timer C */	
+/**
+ * @brief Software timer
+ */
+struct soft_timer {
+	uint64_t deadline;				/*!< Next callback time (in us, hardware timer count) */
+	uint32_t period;				/*!< Period (in us) */
+	bool one_shot;					/*!< Callback is called only once */
+	void (*func_p)(void*);			/*!< Pointer to callback function */
+	void *param_p;					/*!< Pointer to callback function parameter */
+	uint32_t overruns;				/*!< Missed periods */
+	int32_t heap_index;				/*!< Position in the deadline heap (NOT_ARMED if disarmed) */
+	uint32_t elapsed;				/*!< Count kept while a legacy timer is stopped */
+};
+gptimer_handle_t timer_hw = NULL;	/*!< Hardware timer shared by every software timer */
 /**
  * @brief Configuration for the timer
  * 
@@ -32,159 +49,373 @@ const gptimer_config_t timer_config = {
     .direction = GPTIMER_COUNT_UP,		/*!< Count up */
     .resolution_hz = US_RESOLUTION_HZ,	/*!< Resolution in Hz */
 };
-void (*timer_a_isr_p)(void*);	        /*!< Pointer to the ISR function for timer A */	
-void (*timer_b_isr_p)(void*);	        /*!< Pointer to the ISR function for timer B */	
-void (*timer_c_isr_p)(void*);	        /*!< Pointer to the ISR function for timer C */	
+static struct soft_timer **timer_heap = NULL;	/*!< Armed timers, ordered by deadline */
+static uint32_t timer_heap_size = 0;			/*!< Capacity of timer_heap */
+static uint32_t timer_heap_qty = 0;				/*!< Armed timers */
+static uint32_t timer_qty = 0;					/*!< Created timers */
+static portMUX_TYPE timer_lock = portMUX_INITIALIZER_UNLOCKED;
+timer_handle_t timer_legacy[LEGACY_TIMER_QTY] = {NULL};	/*!< Software timers behind TIMER_A, TIMER_B and TIMER_C */
+timer_handle_t timer_cycles = NULL;			/*!< Software timer that keeps the cycle counter extension */
+static uint32_t cycles_high = 0;			/*!< Cycle counter wraps */
+static uint32_t cycles_last = 0;			/*!< Last cycle counter read */
+static portMUX_TYPE cycles_lock = portMUX_INITIALIZER_UNLOCKED;
+/*==================[internal functions declaration]=========================*/
+static void IRAM_ATTR TimerHeapSwap(uint32_t a, uint32_t b){
+	struct soft_timer *t = timer_heap[a];
+	timer_heap[a] = timer_heap[b];
+	timer_heap[b] = t;
+	timer_heap[a]->heap_index = a;
+	timer_heap[b]->heap_index = b;
+}
 
+static void IRAM_ATTR TimerHeapUp(uint32_t i){
+	while(i > 0){
+		uint32_t parent = (i - 1) / 2;
+		if(timer_heap[parent]->deadline <= timer_heap[i]->deadline){
+			break;
+		}
+		TimerHeapSwap(i, parent);
+		i = parent;
+	}
+}
 
-void *timer_a_user_data;	            /*!< User data for timer A */	
-void *timer_b_user_data;	            /*!< User data for timer B */	
-void *timer_c_user_data;	            /*!< User data for timer C */	
+static void IRAM_ATTR TimerHeapDown(uint32_t i){
+	while(true){
+		uint32_t min = i;
+		uint32_t left = 2 * i + 1;
+		uint32_t right = left + 1;
+		if((left < timer_heap_qty) && (timer_heap[left]->deadline < timer_heap[min]->deadline)){
+			min = left;
+		}
+		if((right < timer_heap_qty) && (timer_heap[right]->deadline < timer_heap[min]->deadline)){
+			min = right;
+		}
+		if(min == i){
+			break;
+		}
+		TimerHeapSwap(i, min);
+		i = min;
+	}
+}
 
-gptimer_alarm_config_t alarm_config_a;  /*!< Configuration for alarm A */
-gptimer_alarm_config_t alarm_config_b;	/*!< Configuration for alarm B */
-gptimer_alarm_config_t alarm_config_c;	/*!< Configuration for alarm C */
-/*==================[internal functions declaration]=========================*/
-static bool IRAM_ATTR timer_a_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
-	timer_a_isr_p(timer_a_user_data);
-	return true;
+static void IRAM_ATTR TimerHeapPush(struct soft_timer *timer){
+	timer->heap_index = timer_heap_qty;
+	timer_heap[timer_heap_qty++] = timer;
+	TimerHeapUp(timer->heap_index);
 }
-static bool IRAM_ATTR timer_b_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
-	timer_b_isr_p(timer_b_user_data);
-	return true;
+
+static void IRAM_ATTR TimerHeapRemove(struct soft_timer *timer){
+	uint32_t i = timer->heap_index;
+	timer->heap_index = NOT_ARMED;
+	if(--timer_heap_qty == i){
+		return;
+	}
+	timer_heap[i] = timer_heap[timer_heap_qty];
+	timer_heap[i]->heap_index = i;
+	TimerHeapUp(i);
+	TimerHeapDown(timer_heap[i]->heap_index);
 }
-static bool IRAM_ATTR timer_c_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
-	timer_c_isr_p(timer_c_user_data);
+
+static inline uint64_t IRAM_ATTR TimerNow(void){
+	uint64_t count = 0;
+	gptimer_get_raw_count(timer_hw, &count);
+	return count;
+}
+
+/**
+ * @brief Set the hardware alarm to the nearest deadline (must be called with timer_lock taken)
+ */
+static void IRAM_ATTR TimerAlarmUpdate(void){
+	if(timer_heap_qty == 0){
+		return;
+	}
+	// alarms set in the past are triggered immediately
+	gptimer_alarm_config_t alarm = {
+		.alarm_count = timer_heap[0]->deadline,
+	};
+	gptimer_set_alarm_action(timer_hw, &alarm);
+}
+
+static bool IRAM_ATTR timer_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data){
+	portENTER_CRITICAL_ISR(&timer_lock);
+	uint64_t now = TimerNow();
+	while((timer_heap_qty > 0) && (timer_heap[0]->deadline <= now)){
+		struct soft_timer *t = timer_heap[0];
+		TimerHeapRemove(t);
+		if(!t->one_shot){
+			t->deadline += t->period;
+			if(t->deadline <= now){
+				// skip missed periods, keeping the timer phase
+				uint32_t missed = (now - t->deadline) / t->period + 1;
+				t->overruns += missed;
+				t->deadline += (uint64_t)missed * t->period;
+			}
+			TimerHeapPush(t);
+		}
+		// callback may arm/disarm timers
+		portEXIT_CRITICAL_ISR(&timer_lock);
+		t->func_p(t->param_p);
+		portENTER_CRITICAL_ISR(&timer_lock);
+		now = TimerNow();
+	}
+	TimerAlarmUpdate();
+	portEXIT_CRITICAL_ISR(&timer_lock);
 	return true;
 }
+static void IRAM_ATTR TimerCyclesUpdate(void *param){
+	TimerGetCycles();
+}
 /*==================[internal data definition]===============================*/
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/**
+ * @brief Start the shared hardware timer (first call only)
+ *
+ * @return false if the hardware timer could not be started
+ */
+static bool TimerHwInit(void){
+	gptimer_handle_t timer;
+	gptimer_event_callbacks_t alarm = {
+		.on_alarm = timer_isr,
+	};
+	if(timer_hw != NULL){
+		return true;
+	}
+	if(gptimer_new_timer(&timer_config, &timer) != ESP_OK){
+		return false;
+	}
+	if((gptimer_register_event_callbacks(timer, &alarm, NULL) != ESP_OK) || (gptimer_enable(timer) != ESP_OK)){
+		gptimer_del_timer(timer);
+		return false;
+	}
+	if(gptimer_start(timer) != ESP_OK){
+		gptimer_disable(timer);
+		gptimer_del_timer(timer);
+		return false;
+	}
+	// no alarm is set until a timer is armed, so the ISR never runs before this
+	timer_hw = timer;
+	return true;
+}
+
+/**
+ * @brief Count one more timer, making room for it in the heap
+ *
+ * The room check and the count are done in the same critical section, so concurrent 
+ * TimerCreate() calls never count more timers than the heap holds.
+ *
+ * @return false if there is not enough memory
+ */
+static bool TimerHeapReserve(void){
+	while(true){
+		portENTER_CRITICAL(&timer_lock);
+		if(timer_qty < timer_heap_size){
+			timer_qty++;
+			portEXIT_CRITICAL(&timer_lock);
+			return true;
+		}
+		uint32_t size = (timer_heap_size == 0) ? HEAP_SIZE_INIT : 2 * timer_heap_size;
+		portEXIT_CRITICAL(&timer_lock);
+		// malloc can't be called in a critical section: grow and check again
+		struct soft_timer **heap = malloc(size * sizeof(struct soft_timer*));
+		if(heap == NULL){
+			return false;
+		}
+		struct soft_timer **old = heap;
+		portENTER_CRITICAL(&timer_lock);
+		if(size > timer_heap_size){
+			old = timer_heap;
+			if(old != NULL){
+				memcpy(heap, old, timer_heap_qty * sizeof(struct soft_timer*));
+			}
+			timer_heap = heap;
+			timer_heap_size = size;
+		}
+		portEXIT_CRITICAL(&timer_lock);
+		// the previous heap, or the new one if another task grew it first
+		free(old);
+	}
+}
+
+/**
+ * @brief Arm a timer with its first deadline delay us from now
+ */
+static void IRAM_ATTR TimerArmAfter(struct soft_timer *timer, uint32_t delay){
+	portENTER_CRITICAL_SAFE(&timer_lock);
+	if(timer->heap_index != NOT_ARMED){
+		TimerHeapRemove(timer);
+	}
+	timer->deadline = TimerNow() + delay;
+	TimerHeapPush(timer);
+	if(timer->heap_index == 0){
+		TimerAlarmUpdate();
+	}
+	portEXIT_CRITICAL_SAFE(&timer_lock);
+}
 
 /*==================[external functions definition]==========================*/
+timer_handle_t TimerCreate(timer_handle_config_t *config){
+	// a periodic timer with no period would be re-armed forever inside the ISR
+	if(!config->one_shot && (config->period == 0)){
+		return NULL;
+	}
+	if(!TimerHwInit()){
+		return NULL;
+	}
+	struct soft_timer *timer = malloc(sizeof(struct soft_timer));
+	if(timer == NULL){
+		return NULL;
+	}
+	if(!TimerHeapReserve()){
+		free(timer);
+		return NULL;
+	}
+	timer->period = config->period;
+	timer->one_shot = config->one_shot;
+	timer->func_p = config->func_p;
+	timer->param_p = config->param_p;
+	timer->overruns = 0;
+	timer->heap_index = NOT_ARMED;
+	timer->elapsed = 0;
+	return timer;
+}
+
+void TimerDelete(timer_handle_t timer){
+	TimerDisarm(timer);
+	portENTER_CRITICAL(&timer_lock);
+	timer_qty--;
+	portEXIT_CRITICAL(&timer_lock);
+	free(timer);
+}
+
+void IRAM_ATTR TimerArm(timer_handle_t timer){
+	TimerArmAfter(timer, timer->period);
+}
+
+void IRAM_ATTR TimerDisarm(timer_handle_t timer){
+	portENTER_CRITICAL_SAFE(&timer_lock);
+	if(timer->heap_index != NOT_ARMED){
+		TimerHeapRemove(timer);
+	}
+	portEXIT_CRITICAL_SAFE(&timer_lock);
+}
+
+void IRAM_ATTR TimerSetPeriod(timer_handle_t timer, uint32_t period){
+	if(!timer->one_shot && (period == 0)){
+		return;
+	}
+	portENTER_CRITICAL_SAFE(&timer_lock);
+	if(timer->heap_index != NOT_ARMED){
+		TimerHeapRemove(timer);
+		timer->deadline = timer->deadline - timer->period + period;
+		timer->period = period;
+		TimerHeapPush(timer);
+		TimerAlarmUpdate();
+	} else {
+		timer->period = period;
+	}
+	portEXIT_CRITICAL_SAFE(&timer_lock);
+}
+
+bool TimerIsArmed(timer_handle_t timer){
+	return (timer->heap_index != NOT_ARMED);
+}
+
+uint32_t TimerOverruns(timer_handle_t timer){
+	return timer->overruns;
+}
+
+void TimerTimestampInit(void){
+	if(timer_cycles != NULL){
+		return;
+	}
+	timer_handle_config_t config = {
+		.period = (UINT32_MAX / esp_rom_get_cpu_ticks_per_us()) / CYCLES_WRAP_CHECKS,
+		.one_shot = false,
+		.func_p = TimerCyclesUpdate,
+		.param_p = NULL,
+	};
+	timer_cycles = TimerCreate(&config);
+	TimerArm(timer_cycles);
+}
+
+uint64_t IRAM_ATTR TimerGetCycles(void){
+	portENTER_CRITICAL_SAFE(&cycles_lock);
+	uint32_t low = esp_cpu_get_cycle_count();
+	if(low < cycles_last){
+		cycles_high++;
+	}
+	cycles_last = low;
+	uint64_t cycles = ((uint64_t)cycles_high << 32) | low;
+	portEXIT_CRITICAL_SAFE(&cycles_lock);
+	return cycles;
+}
+
 void TimerInit(timer_config_t *timer_ini){
-	switch(timer_ini->timer){
-	 	case TIMER_A:
-			timer_a_isr_p = timer_ini->func_p;
-			timer_a_user_data = timer_ini->param_p;
-	 		gptimer_new_timer(&timer_config, &timer_a);
-			alarm_config_a.alarm_count = timer_ini->period; 
-			alarm_config_a.reload_count = RESET_COUNT_VALUE;
-			alarm_config_a.flags.auto_reload_on_alarm = true;
-			gptimer_set_alarm_action(timer_a, &alarm_config_a);
-			gptimer_event_callbacks_t alarm_a = {
-				.on_alarm = timer_a_isr,
-			};
-			gptimer_register_event_callbacks(timer_a, &alarm_a, NULL);
-			gptimer_enable(timer_a);
-	 	break;
-
-	 	case TIMER_B:
-			timer_b_isr_p = timer_ini->func_p;
-			timer_b_user_data = timer_ini->param_p;
-	 		gptimer_new_timer(&timer_config, &timer_b);
-			alarm_config_b.alarm_count = timer_ini->period; 
-			alarm_config_b.reload_count = RESET_COUNT_VALUE;
-			alarm_config_b.flags.auto_reload_on_alarm = true;
-			gptimer_set_alarm_action(timer_b, &alarm_config_b);
-			gptimer_event_callbacks_t alarm_b = {
-				.on_alarm = timer_b_isr,
-			};
-			gptimer_register_event_callbacks(timer_b, &alarm_b, NULL);
-			gptimer_enable(timer_b);
-	 	break;
-
-	 	case TIMER_C:
-			timer_c_isr_p = timer_ini->func_p;
-			timer_c_user_data = timer_ini->param_p;
-	 		gptimer_new_timer(&timer_config, &timer_c);
-			alarm_config_c.alarm_count = timer_ini->period; 
-			alarm_config_c.reload_count = RESET_COUNT_VALUE;
-			alarm_config_c.flags.auto_reload_on_alarm = true;
-			gptimer_set_alarm_action(timer_c, &alarm_config_c);
-			gptimer_event_callbacks_t alarm_c = {
-				.on_alarm = timer_c_isr,
-			};
-			gptimer_register_event_callbacks(timer_c, &alarm_c, NULL);
-			gptimer_enable(timer_c);
-	 	break;
+	timer_handle_config_t config = {
+		.period = timer_ini->period,
+		.one_shot = false,
+		.func_p = timer_ini->func_p,
+		.param_p = timer_ini->param_p,
+	};
+	if(timer_legacy[timer_ini->timer] != NULL){
+		TimerDelete(timer_legacy[timer_ini->timer]);
 	}
+	timer_legacy[timer_ini->timer] = TimerCreate(&config);
 }
 
 void TimerStart(timer_mcu_t timer){
-	switch(timer){
-	 	case TIMER_A:
-	 		gptimer_start(timer_a);
-		break;
-	 	case TIMER_B:
-	 		gptimer_start(timer_b);
-		break;
-	 	case TIMER_C:
-	 		gptimer_start(timer_c);
-		break;
+	struct soft_timer *t = timer_legacy[timer];
+	if(t == NULL){
+		return;
+	}
+	if(t->heap_index == NOT_ARMED){
+		// resume from the count kept by TimerStop()
+		TimerArmAfter(t, (t->elapsed < t->period) ? t->period - t->elapsed : 0);
 	}
 }
 
 uint32_t TimerRead(timer_mcu_t timer){
-	uint64_t raw_count = 0;
-	switch(timer){
-	 	case TIMER_A:
-	 		gptimer_get_raw_count(timer_a, &raw_count);
-	 	break;
-	 	case TIMER_B:
-	 		gptimer_get_raw_count(timer_b, &raw_count);
-	 	break;
-	 	case TIMER_C:
-	 		gptimer_get_raw_count(timer_c, &raw_count);
-	 	break;
+	struct soft_timer *t = timer_legacy[timer];
+	uint32_t count;
+	if(t == NULL){
+		return 0;
 	}
-	return raw_count;
+	portENTER_CRITICAL(&timer_lock);
+	if(t->heap_index == NOT_ARMED){
+		count = t->elapsed;
+	} else {
+		int64_t remaining = (int64_t)(t->deadline - TimerNow());
+		count = (remaining > 0) ? t->period - remaining : t->period;
+	}
+	portEXIT_CRITICAL(&timer_lock);
+	return count;
 }
 
 void TimerStop(timer_mcu_t timer){
-	switch(timer){
-	 	case TIMER_A:
-	 		gptimer_stop(timer_a);
-	 	break;
-	 	case TIMER_B:
-	 		gptimer_stop(timer_b);
-	 	break;
-	 	case TIMER_C:
-	 		gptimer_stop(timer_c);
-	 	break;
+	struct soft_timer *t = timer_legacy[timer];
+	if((t != NULL) && (t->heap_index != NOT_ARMED)){
+		t->elapsed = TimerRead(timer);
+		TimerDisarm(t);
 	}
 }
 
 void TimerReset(timer_mcu_t timer){
-	switch(timer){
-	 	case TIMER_A:
-			gptimer_set_raw_count(timer_a, RESET_COUNT_VALUE);
-	 	break;
-	 	case TIMER_B:
-			gptimer_set_raw_count(timer_b, RESET_COUNT_VALUE);
-	 	break;
-	 	case TIMER_C:
-			gptimer_set_raw_count(timer_c, RESET_COUNT_VALUE);
-	 	break;
+	struct soft_timer *t = timer_legacy[timer];
+	if(t == NULL){
+		return;
+	}
+	t->elapsed = RESET_COUNT_VALUE;
+	if(t->heap_index != NOT_ARMED){
+		TimerArm(t);
 	}
 }
 
 void TimerUpdatePeriod(timer_mcu_t timer, uint32_t period){
-	switch(timer){
-	 	case TIMER_A:
-			alarm_config_a.alarm_count = period;
-			gptimer_set_alarm_action(timer_a, &alarm_config_a);
-	 	break;
-	 	case TIMER_B:
-			alarm_config_b.alarm_count = period;
-			gptimer_set_alarm_action(timer_b, &alarm_config_b);
-	 	break;
-	 	case TIMER_C:
-			alarm_config_c.alarm_count = period;
-			gptimer_set_alarm_action(timer_c, &alarm_config_c);
-	 	break;
+	if(timer_legacy[timer] != NULL){
+		TimerSetPeriod(timer_legacy[timer], period);
 	}
 }
 
@@ -11,132 +11,353 @@
 
 /*==================[inclusions]=============================================*/
 #include "uart_mcu.h"
+#include <string.h>
 #include "gpio_mcu.h"
+#include "format_mcu.h"
 #include "driver/uart.h"
+#include "soc/soc_caps.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "timer_mcu.h"
+#include "spi_mcu.h"
 #include "esp_log.h"
 /*==================[macros and definitions]=================================*/
 #define UART_CONN_TX        GPIO_18         /*!<  */
 #define UART_CONN_RX        GPIO_19         /*!<  */
-#define TX_BUFFER_SIZE      256             /*!<  */
+#define UART_CONN_RTS       GPIO_23         /*!< RTS output when flow control is enabled (shared with LCD BCD4) */
+#define UART_CONN_CTS       GPIO_22         /*!< CTS input when flow control is enabled (shared with SPI MISO, LCD BCD3 and L293 EN_1_2) */
+#define TX_BUFFER_SIZE      2048            /*!< Bytes queued for transmission without blocking */
 #define RX_BUFFER_SIZE      256             /*!<  */
+#define BUFFER_SIZE_MIN     129             /*!< Driver rings must be bigger than the hardware FIFO */
+#define FLOW_CTRL_THRESH    100             /*!< RX FIFO level that deasserts RTS */
+#define RX_FULL_THRESH_MAX  (SOC_UART_FIFO_LEN - 1) /*!< Highest RX FIFO full threshold */
 #define EVENT_QUEUE_SIZE    16              /*!<  */
+#define EVENT_TASK_STACK    2048            /*!<  */
+#define LINE_TASK_STACK     3072            /*!< Line mode task stack (command callbacks run on it) */
 #define READ_TIMEOUT        100             /*!<  */
+#define PATTERN_CHR_NUM     1               /*!< Delimiter is a single character */
+#define PATTERN_CHR_TOUT    9               /*!< Maximum gap (in baud cycles) between delimiter characters */
+#define BENCH_BLOCK_SIZE    256             /*!< Bytes written and read on each loopback benchmark iteration */
+#define TX_TASK_STACK       2048            /*!< Asynchronous transmission task stack */
+#define TX_CHUNK_SIZE       128             /*!< Bytes moved from the asynchronous queue to the driver at once */
 /*==================[internal data declaration]==============================*/
-void (*uart_pc_isr_p)(void*);	            /*!<  */
-void (*uart_conn_isr_p)(void*);	            /*!<  */
-void *uart_pc_user_data;	                /*!<  */
-void *uart_conn_user_data;	                /*!<  */
-static QueueHandle_t uart_pc_queue;         /*!<  */
-static QueueHandle_t uart_conn_queue;       /*!<  */
+/**
+ * @brief Line mode state of a port
+ */
+typedef struct {
+    uart_line_config_t config;              /*!< Line mode configuration */
+    char line[UART_LINE_SIZE];              /*!< Line read from the reception ring buffer */
+} uart_line_t;
+/**
+ * @brief Driver state of a port
+ */
+typedef struct {
+    void (*func_p)(void*);                  /*!< Reception callback (NULL if not requiered) */
+    void *param_p;                          /*!< Reception callback parameters */
+    QueueHandle_t queue;                    /*!< Driver event queue */
+    uint16_t tx_size;                       /*!< Transmission ring buffer size */
+    StreamBufferHandle_t tx_stream;         /*!< Asynchronous transmission queue (NULL until the first UartSendBufferAsync()) */
+    SemaphoreHandle_t tx_mutex;             /*!< Serializes the writers of tx_stream */
+    StaticSemaphore_t tx_mutex_buffer;      /*!< Memory of tx_mutex */
+    volatile uint16_t tx_in_hand;           /*!< Bytes taken from tx_stream and not yet in the driver ring */
+    void (*tx_done_func_p)(void*);          /*!< Asynchronous transmission done callback (NULL if not requiered) */
+    void *tx_done_param_p;                  /*!< Asynchronous transmission done callback parameters */
+    uart_line_t *line_mode;                 /*!< Line mode state (NULL when not in line mode) */
+    volatile bool bench;                    /*!< UartLoopbackBenchmark() running: the event task does not read data */
+    uart_stats_t stats;                     /*!< Event counters */
+} uart_port_data_t;
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
-
+static uart_port_data_t uart_port[2];       /*!< Driver state (one per port) */
+static uart_line_t uart_line[2];            /*!< Line mode state (one per port) */
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
-static void uart_pc_event_task(void *pvParameters){
+static uart_port_t UartNum(uart_mcu_port_t port){
+    return (port == UART_CONNECTOR) ? UART_NUM_1 : UART_NUM_0;
+}
+
+static void UartLineDispatch(uart_line_t *line_mode){
+    char *line = line_mode->line;
+    char *args = strchr(line, ' ');
+    if(args != NULL){
+        *args++ = '\0';
+    } else {
+        args = line + strlen(line);
+    }
+    for(uint8_t i = 0; i < line_mode->config.command_qty; i++){
+        const uart_command_t *command = &line_mode->config.commands[i];
+        if(strcmp(command->name, line) == 0){
+            command->func_p(args, command->param_p);
+            return;
+        }
+    }
+    if(line_mode->config.func_p != NULL){
+        if(*args != '\0'){
+            args[-1] = ' ';
+        }
+        line_mode->config.func_p(line, line_mode->config.param_p);
+    }
+}
+
+static void UartLineRead(uart_line_t *line_mode){
+    uart_port_t uart_num = UartNum(line_mode->config.port);
+    int pos = uart_pattern_pop_pos(uart_num);
+    if(pos < 0){
+        // pattern queue overflowed: line boundaries are lost
+        uart_flush_input(uart_num);
+        uart_pattern_queue_reset(uart_num, EVENT_QUEUE_SIZE);
+        return;
+    }
+    int length = pos + 1;
+    if(length > UART_LINE_SIZE){
+        // line too long: discard it
+        while(length > 0){
+            int read = uart_read_bytes(uart_num, line_mode->line, (length > UART_LINE_SIZE) ? UART_LINE_SIZE : length, 0);
+            if(read <= 0){
+                break;
+            }
+            length -= read;
+        }
+        return;
+    }
+    uart_read_bytes(uart_num, line_mode->line, length, 0);
+    line_mode->line[pos] = '\0';
+    if(pos > 0 && line_mode->line[pos - 1] == '\r'){
+        line_mode->line[pos - 1] = '\0';
+    }
+    UartLineDispatch(line_mode);
+}
+
+static void uart_event_task(void *pvParameters){
+    uart_mcu_port_t port = (uart_mcu_port_t)pvParameters;
+    uart_port_data_t *data = &uart_port[port];
+    uart_port_t uart_num = UartNum(port);
     uart_event_t event;
-    uart_driver_install(UART_NUM_0, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 16, &uart_pc_queue, 0);
     while(1){
         //Waiting for UART event.
-        if (xQueueReceive(uart_pc_queue, (void *)&event, (TickType_t)portMAX_DELAY)){
+        if(xQueueReceive(data->queue, (void *)&event, (TickType_t)portMAX_DELAY)){
             switch(event.type) {
                 case UART_DATA:
-                    uart_pc_isr_p(uart_pc_user_data);
-                    break;
-                case UART_BREAK:
+                    data->stats.rx_bytes += event.size;
+                    if(data->func_p != NULL && !data->bench){
+                        data->func_p(data->param_p);
+                    }
                     break;
-                case UART_BUFFER_FULL:
+                case UART_PATTERN_DET:
+                    if(data->line_mode != NULL && !data->bench){
+                        UartLineRead(data->line_mode);
+                    }
                     break;
                 case UART_FIFO_OVF:
+                    data->stats.fifo_ovf++;
+                    // data lost: restart from an empty ring buffer
+                    uart_flush_input(uart_num);
+                    uart_pattern_queue_reset(uart_num, EVENT_QUEUE_SIZE);
+                    xQueueReset(data->queue);
+                    break;
+                case UART_BUFFER_FULL:
+                    data->stats.buffer_full++;
+                    uart_flush_input(uart_num);
+                    uart_pattern_queue_reset(uart_num, EVENT_QUEUE_SIZE);
+                    xQueueReset(data->queue);
                     break;
                 case UART_FRAME_ERR:
+                    data->stats.frame_err++;
                     break;
                 case UART_PARITY_ERR:
+                    data->stats.parity_err++;
                     break;
-                case UART_DATA_BREAK:
-                    break;
-                case UART_PATTERN_DET:
-                    break;
-                case UART_WAKEUP:
-                    break;
-                case UART_EVENT_MAX:
+                default:
                     break;
             }
         }
     }
 }
 
-static void uart_conn_event_task(void *pvParameters){
-    uart_event_t event;
-    uart_driver_install(UART_NUM_1, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 16, &uart_conn_queue, 0);
+/**
+ * @brief Move the asynchronous transmission queue to the driver ring buffer
+ * 
+ * uart_write_bytes() blocks while the driver ring has no room (it also stores a descriptor 
+ * and item headers for each write), so it is only called from this task.
+ */
+static void uart_tx_task(void *pvParameters){
+    uart_mcu_port_t port = (uart_mcu_port_t)pvParameters;
+    uart_port_data_t *data = &uart_port[port];
+    uint8_t chunk[TX_CHUNK_SIZE];
     while(1){
-        //Waiting for UART event.
-        if(xQueueReceive(uart_conn_queue, (void *)&event, (TickType_t)portMAX_DELAY)){
-            switch(event.type) {
-                case UART_DATA:
-                    uart_conn_isr_p(uart_conn_user_data);
-                    break;
-                case UART_BREAK:
-                    break;
-                case UART_BUFFER_FULL:
-                    break;
-                case UART_FIFO_OVF:
-                    break;
-                case UART_FRAME_ERR:
-                    break;
-                case UART_PARITY_ERR:
-                    break;
-                case UART_DATA_BREAK:
-                    break;
-                case UART_PATTERN_DET:
-                    break;
-                case UART_WAKEUP:
-                    break;
-                case UART_EVENT_MAX:
-                    break;
+        data->tx_in_hand = xStreamBufferReceive(data->tx_stream, chunk, TX_CHUNK_SIZE, portMAX_DELAY);
+        if(data->tx_in_hand > 0){
+            uart_write_bytes(UartNum(port), chunk, data->tx_in_hand);
+            data->tx_in_hand = 0;
+        }
+        void (*tx_done_func_p)(void*) = data->tx_done_func_p;
+        // only waits for the line once the queue runs dry, so it doesn't slow down a busy queue
+        if((tx_done_func_p != NULL) && xStreamBufferIsEmpty(data->tx_stream)){
+            if((uart_wait_tx_done(UartNum(port), portMAX_DELAY) == ESP_OK) && xStreamBufferIsEmpty(data->tx_stream)){
+                tx_done_func_p(data->tx_done_param_p);
             }
         }
     }
 }
-/*==================[external functions definition]==========================*/
 
-void UartInit(serial_config_t *port_config){
+/**
+ * @brief Create the asynchronous transmission queue of a port (must be called with tx_mutex taken)
+ * 
+ * @return false if there is not enough memory
+ */
+static bool UartTxStreamInit(uart_mcu_port_t port){
+    uart_port_data_t *data = &uart_port[port];
+    if(data->tx_stream != NULL){
+        return true;
+    }
+    data->tx_stream = xStreamBufferCreate(data->tx_size, 1);
+    if(data->tx_stream == NULL){
+        return false;
+    }
+    if(xTaskCreate(uart_tx_task, "uart_tx_task", TX_TASK_STACK, (void *)port, 12, NULL) != pdPASS){
+        vStreamBufferDelete(data->tx_stream);
+        data->tx_stream = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void UartSetup(serial_config_t *port_config, uint32_t task_stack){
+    uart_mcu_port_t port = port_config->port;
+    uart_port_t uart_num = UartNum(port);
+    uint16_t rx_size = (port_config->rx_buffer_size >= BUFFER_SIZE_MIN) ? port_config->rx_buffer_size : RX_BUFFER_SIZE;
+    uart_port[port].tx_size = (port_config->tx_buffer_size >= BUFFER_SIZE_MIN) ? port_config->tx_buffer_size : TX_BUFFER_SIZE;
     uart_config_t uart_config = {
         .baud_rate = port_config->baud_rate,
         .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .rx_flow_ctrl_thresh = FLOW_CTRL_THRESH,
         .source_clk = UART_SCLK_DEFAULT,
     };
-    switch(port_config->port){
-        case UART_PC:
-            uart_param_config(UART_NUM_0, &uart_config);
-            uart_set_pin(UART_NUM_0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            if(port_config->func_p != UART_NO_INT){
-                uart_pc_isr_p = port_config->func_p;
-                uart_pc_queue = port_config->param_p;
-                xTaskCreate(uart_pc_event_task, "uart_pc_event_task", 2048, NULL, 12, 0);
-            }else{
-                uart_driver_install(UART_NUM_0, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 0, NULL, 0);
-            }
-            break;
-        case UART_CONNECTOR:
-            uart_param_config(UART_NUM_1, &uart_config);
-            uart_set_pin(UART_NUM_1, UART_CONN_TX, UART_CONN_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-            if(port_config->func_p != UART_NO_INT){
-                uart_conn_isr_p = port_config->func_p;
-                uart_conn_queue = port_config->param_p;
-                xTaskCreate(uart_conn_event_task, "uart_conn_event_task", 2048, NULL, 12, NULL);
-            }else{
-                uart_driver_install(UART_NUM_1, RX_BUFFER_SIZE, TX_BUFFER_SIZE, 0, NULL, 0);
+    if(port == UART_CONNECTOR){
+        // every free pin of the board is taken: CTS would steal MISO from the SPI bus
+        bool flow_ctrl = port_config->flow_ctrl && !SpiBusInitialized();
+        if(flow_ctrl){
+            uart_config.flow_ctrl = UART_HW_FLOWCTRL_CTS_RTS;
+        }
+        uart_param_config(UART_NUM_1, &uart_config);
+        uart_set_pin(UART_NUM_1, UART_CONN_TX, UART_CONN_RX, 
+            flow_ctrl ? UART_CONN_RTS : UART_PIN_NO_CHANGE, 
+            flow_ctrl ? UART_CONN_CTS : UART_PIN_NO_CHANGE);
+    } else {
+        uart_param_config(UART_NUM_0, &uart_config);
+        uart_set_pin(UART_NUM_0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    }
+    uart_driver_install(uart_num, rx_size, uart_port[port].tx_size, EVENT_QUEUE_SIZE, &uart_port[port].queue, 0);
+    if(uart_port[port].tx_mutex == NULL){
+        uart_port[port].tx_mutex = xSemaphoreCreateMutexStatic(&uart_port[port].tx_mutex_buffer);
+    }
+    if(port_config->rx_full_thresh != 0){
+        uart_set_rx_full_threshold(uart_num, (port_config->rx_full_thresh > RX_FULL_THRESH_MAX) ? 
+            RX_FULL_THRESH_MAX : port_config->rx_full_thresh);
+    }
+    if(port_config->rx_timeout != 0){
+        uart_set_rx_timeout(uart_num, port_config->rx_timeout);
+    }
+    uart_set_loop_back(uart_num, port_config->loopback);
+    xTaskCreate(uart_event_task, "uart_event_task", task_stack, (void *)port, 12, NULL);
+}
+/*==================[external functions definition]==========================*/
+
+void UartInit(serial_config_t *port_config){
+    uart_port_data_t *data = &uart_port[port_config->port];
+    data->func_p = port_config->func_p;
+    data->param_p = port_config->param_p;
+    data->line_mode = NULL;
+    UartSetup(port_config, EVENT_TASK_STACK);
+}
+
+void UartLineInit(uart_line_config_t *line_config){
+    uart_line_t *line_mode = &uart_line[line_config->port];
+    uart_port_data_t *data = &uart_port[line_config->port];
+    uart_port_t uart_num = UartNum(line_config->port);
+    serial_config_t port_config = {
+        .port = line_config->port,
+        .baud_rate = line_config->baud_rate,
+        .rx_buffer_size = line_config->rx_buffer_size,
+        .tx_buffer_size = line_config->tx_buffer_size,
+        .flow_ctrl = line_config->flow_ctrl,
+        .rx_full_thresh = line_config->rx_full_thresh,
+        .rx_timeout = line_config->rx_timeout,
+        .loopback = line_config->loopback,
+    };
+    line_mode->config = *line_config;
+    data->func_p = NULL;
+    data->line_mode = line_mode;
+    UartSetup(&port_config, LINE_TASK_STACK);
+    uart_enable_pattern_det_baud_intr(uart_num, line_config->delimiter, PATTERN_CHR_NUM, PATTERN_CHR_TOUT, 0, 0);
+    uart_pattern_queue_reset(uart_num, EVENT_QUEUE_SIZE);
+}
+
+void UartGetStats(uart_mcu_port_t port, uart_stats_t *stats){
+    *stats = uart_port[port].stats;
+}
+
+void UartResetStats(uart_mcu_port_t port){
+    memset(&uart_port[port].stats, 0, sizeof(uart_stats_t));
+}
+
+void UartLoopbackBenchmark(uart_mcu_port_t port, uint32_t duration, uart_bench_t *result){
+    uart_port_t uart_num = UartNum(port);
+    uint8_t tx_block[BENCH_BLOCK_SIZE];
+    uint8_t rx_block[BENCH_BLOCK_SIZE];
+    uint8_t tx_value = 0, rx_value = 0;
+    uint64_t busy_cycles = 0;
+    uint32_t fifo_ovf = uart_port[port].stats.fifo_ovf;
+    memset(result, 0, sizeof(uart_bench_t));
+    // the benchmark is the only reader of the ring buffer while it runs
+    uart_port[port].bench = true;
+    uart_set_loop_back(uart_num, true);
+    uart_flush_input(uart_num);
+    uint64_t start = TimerGetUs();
+    uint64_t end = start + (uint64_t)duration * 1000;
+    while(TimerGetUs() < end){
+        uint32_t cycles = TimerGetCycles32();
+        for(uint16_t i = 0; i < BENCH_BLOCK_SIZE; i++){
+            tx_block[i] = tx_value + i;
+        }
+        uint16_t sent = UartSendBufferAsync(port, (const char *)tx_block, BENCH_BLOCK_SIZE);
+        tx_value += sent;
+        int read = uart_read_bytes(uart_num, rx_block, BENCH_BLOCK_SIZE, 0);
+        for(int i = 0; i < read; i++){
+            if(rx_block[i] != rx_value){
+                result->errors++;
             }
-            break;
+            rx_value = rx_block[i] + 1;
+        }
+        if(read > 0){
+            result->bytes += read;
+        }
+        busy_cycles += (uint32_t)(TimerGetCycles32() - cycles);
+        if(sent == 0 && read <= 0){
+            // nothing to do until the driver moves data
+            vTaskDelay(1);
+        }
+    }
+    uint64_t elapsed = TimerGetUs() - start;
+    uart_wait_tx_done(uart_num, pdMS_TO_TICKS(READ_TIMEOUT));
+    uart_flush_input(uart_num);
+    if(uart_port[port].line_mode != NULL){
+        // line ends detected during the benchmark point to flushed data
+        uart_pattern_queue_reset(uart_num, EVENT_QUEUE_SIZE);
     }
+    uart_set_loop_back(uart_num, false);
+    uart_port[port].bench = false;
+    result->bytes_per_s = (uint64_t)result->bytes * 1000000 / elapsed;
+    result->fifo_ovf = uart_port[port].stats.fifo_ovf - fifo_ovf;
+    result->cpu_load = TimerCyclesToUs(busy_cycles) * 100 / elapsed;
 }
 
 uint8_t UartReadByte(uart_mcu_port_t port, uint8_t* data){
@@ -178,58 +399,84 @@ uint8_t UartReadBuffer(uart_mcu_port_t port, uint8_t* data, uint16_t nbytes){
 }
 
 void UartSendByte(uart_mcu_port_t port, const char *data){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
-            break;
-    }
-    uart_tx_chars(uart_num, data, 1);
+    uart_write_bytes(UartNum(port), data, 1);
 }
 
 void UartSendString(uart_mcu_port_t port, const char *msg){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
-            break;
+    uart_write_bytes(UartNum(port), msg, strlen(msg));
+}
+
+void UartSendBuffer(uart_mcu_port_t port, const char *data, uint16_t nbytes){
+    uart_write_bytes(UartNum(port), data, nbytes);
+}
+
+uint16_t UartSendBufferAsync(uart_mcu_port_t port, const char *data, uint16_t nbytes){
+    uart_port_data_t *port_data = &uart_port[port];
+    uint16_t queued = 0;
+    // the mutex is only held while copying, writers never wait for the line
+    xSemaphoreTake(port_data->tx_mutex, portMAX_DELAY);
+    if(UartTxStreamInit(port)){
+        size_t free_size = xStreamBufferSpacesAvailable(port_data->tx_stream);
+        if(nbytes > free_size){
+            nbytes = free_size;
+        }
+        queued = xStreamBufferSend(port_data->tx_stream, data, nbytes, 0);
     }
-	while(*msg != 0){
-        uart_tx_chars(uart_num, msg, 1);
-		msg++;
-	}
+    xSemaphoreGive(port_data->tx_mutex);
+    return queued;
 }
 
-void UartSendBuffer(uart_mcu_port_t port, const char *data, uint8_t nbytes){
-    uart_port_t uart_num = UART_NUM_0;
-    switch(port){
-        case UART_PC:
-                uart_num = UART_NUM_0;
-            break;
-        case UART_CONNECTOR:
-                uart_num = UART_NUM_1;
-            break;
+bool UartSendFrameAsync(uart_mcu_port_t port, const char *data, uint16_t nbytes){
+    uart_port_data_t *port_data = &uart_port[port];
+    bool queued = false;
+    xSemaphoreTake(port_data->tx_mutex, portMAX_DELAY);
+    // the transmission task only frees space, so a frame that fits now is queued whole
+    if(UartTxStreamInit(port) && (xStreamBufferSpacesAvailable(port_data->tx_stream) >= nbytes)){
+        queued = (xStreamBufferSend(port_data->tx_stream, data, nbytes, 0) == nbytes);
     }
-    uart_tx_chars(uart_num, data, nbytes);
+    xSemaphoreGive(port_data->tx_mutex);
+    return queued;
 }
 
-uint8_t* UartItoa(uint32_t val, uint8_t base){
-	static uint8_t buf[32] = {0};
-	uint32_t i = 30;
-    if(val == 0){
-        return (uint8_t*)"0";
-    }else{
-        for(; val && i ; --i, val /= base){
-            buf[i] = "0123456789abcdef"[val % base];
+uint16_t UartTxPending(uart_mcu_port_t port){
+    uart_port_data_t *port_data = &uart_port[port];
+    size_t free_size = port_data->tx_size;
+    uint16_t pending = 0;
+    if(port_data->tx_stream != NULL){
+        pending = xStreamBufferBytesAvailable(port_data->tx_stream) + port_data->tx_in_hand;
+    }
+    uart_get_tx_buffer_free_size(UartNum(port), &free_size);
+    return pending + port_data->tx_size - free_size;
+}
+
+void UartSetTxDoneCallback(uart_mcu_port_t port, void *func_p, void *param_p){
+    uart_port_data_t *port_data = &uart_port[port];
+    // the transmission task reads the function first: clear it while the parameter changes
+    port_data->tx_done_func_p = NULL;
+    port_data->tx_done_param_p = param_p;
+    port_data->tx_done_func_p = func_p;
+}
+
+bool UartTxWaitDone(uart_mcu_port_t port, uint32_t timeout){
+    uart_port_data_t *port_data = &uart_port[port];
+    uint64_t end = TimerGetUs() + (uint64_t)timeout * 1000;
+    // first the asynchronous queue must reach the driver ring
+    while((port_data->tx_stream != NULL) && 
+        (!xStreamBufferIsEmpty(port_data->tx_stream) || (port_data->tx_in_hand > 0))){
+        if(TimerGetUs() >= end){
+            return false;
         }
-        return &buf[i+1];
+        vTaskDelay(1);
     }
+    uint64_t now = TimerGetUs();
+    uint32_t remaining = (now < end) ? (end - now) / 1000 : 0;
+    return (uart_wait_tx_done(UartNum(port), pdMS_TO_TICKS(remaining)) == ESP_OK);
+}
+
+uint8_t* UartItoa(uint32_t val, uint8_t base){
+	static char buf[FORMAT_BIN_SIZE];
+	FormatUint32Base(val, base, buf);
+	return (uint8_t*)buf;
 }
 
 /*==================[end of file]============================================*/
\ No newline at end of file
@@ -16,6 +16,7 @@
  * |   Date	    | Description                                    						|
  * |:----------:|:----------------------------------------------------------------------|
  * | 15/03/2024 | Document creation		                         						|
+ * | 16/10/2026 | Q15 fixed-point FFT		                         						|
  * 
  **/
 
@@ -48,6 +49,28 @@ bool FFTInit(void);
  */
 void FFTMagnitude(float * signal, float * fft, uint16_t signal_lenght);
 
+/**
+ * @brief Initialize the fixed-point (Q15) FFT calculation module
+ * 
+ * @return true     FFT initialized
+ * @return false    Not possible to initialize FFT
+ */
+bool FFTInitQ15(void);
+
+/**
+ * @brief Calculates the Fast Fourier Transform of a given Q15 signal (e.g. ADC_FORMAT_Q15 blocks)
+ * 
+ * Window, FFT and magnitude are calculated with 16 bit fixed-point arithmetic, with the same 
+ * scaling as FFTMagnitude() (a sine of amplitude A returns a peak of A).
+ * 
+ * @note  Lenght of signal array must be a power of two (with maximun value = MAX_SIGNAL_LENGHT)
+ * 
+ * @param signal            Array with Q15 signal values (of lenght = signal_lenght)
+ * @param fft               Array to store Q15 FFT magnitude values (of lenght = signal_lenght / 2)
+ * @param signal_lenght     Lenght of signal arrays
+ */
+void FFTMagnitudeQ15(const int16_t * signal, int16_t * fft, uint16_t signal_lenght);
+
 /**
  * @brief Return the FFT frequency axis vector
  * 
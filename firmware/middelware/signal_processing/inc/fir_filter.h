@@ -0,0 +1,76 @@
+#ifndef FIR_FILTER_H_
+#define FIR_FILTER_H_
+/** \addtogroup Drivers_Programable Drivers Programable
+ ** @{ */
+/** \addtogroup Middelware Middelware
+ ** @{ */
+/** \addtogroup FIR_Filter FIR Filter
+ */
+
+/** \brief Fixed-point (Q15) FIR filters
+ * 
+ * Filters are designed once (windowed sinc, Hamming window) and applied with esp-dsp 16 bit 
+ * fixed-point functions, so signals acquired in ADC_FORMAT_Q15 can be filtered without 
+ * converting them to float.
+ * 
+ * @author Peñalva Albano
+ *
+ * @section changelog
+ *
+ * |   Date	    | Description                                    						|
+ * |:----------:|:----------------------------------------------------------------------|
+ * | 16/10/2026 | Document creation		                         						|
+ * 
+ **/
+
+/*==================[inclusions]=============================================*/
+#include <stdint.h>
+/*==================[macros]=================================================*/
+#define FIR_TAPS_MAX    127     /*!< Maximum number of filter coefficients */
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/**
+ * @brief Initialize a FIR Low Pass Filter
+ * 
+ * @param sample_frec   Signal's sample frequency
+ * @param cut_frec      Filter's cut-off frequency
+ * @param taps          Number of coefficients (odd, up to FIR_TAPS_MAX)
+ */
+void FirLowPassInit(float sample_frec, float cut_frec, uint8_t taps);
+
+/**
+ * @brief Initialize a FIR Hi Pass Filter
+ * 
+ * @param sample_frec   Signal's sample frequency
+ * @param cut_frec      Filter's cut-off frequency
+ * @param taps          Number of coefficients (odd, up to FIR_TAPS_MAX)
+ */
+void FirHiPassInit(float sample_frec, float cut_frec, uint8_t taps);
+
+/**
+ * @brief Apply the FIR low pass filter to a Q15 signal array
+ * 
+ * @param input_signal      Input signal array
+ * @param output_signal     Filtered signal array
+ * @param signal_lenght     Number of samples of both signals
+ */
+void FirLowPassFilter(const int16_t * input_signal, int16_t * output_signal, int16_t signal_lenght);
+
+/**
+ * @brief Apply the FIR hi pass filter to a Q15 signal array
+ * 
+ * @param input_signal      Input signal array
+ * @param output_signal     Filtered signal array
+ * @param signal_lenght     Number of samples of both signals
+ */
+void FirHiPassFilter(const int16_t * input_signal, int16_t * output_signal, int16_t signal_lenght);
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+#endif /* FIR_FILTER_H_ */
+
+/*==================[end of file]============================================*/
@@ -17,9 +17,15 @@
 #include "esp_log.h"
 /*==================[macros and definitions]=================================*/
 #define TAG "FFT Module"
+#ifndef dsps_fft2r_sc16     // esp-dsp only defines it for optimized builds
+#define dsps_fft2r_sc16 dsps_fft2r_sc16_ansi
+#endif
 /*==================[internal data declaration]==============================*/
 static float fft_complex[2 * MAX_SIGNAL_LENGHT];
 static float wind[MAX_SIGNAL_LENGHT];
+static int16_t fft_complex_q15[2 * MAX_SIGNAL_LENGHT];
+static int16_t wind_q15[MAX_SIGNAL_LENGHT];
+static uint16_t wind_q15_lenght = 0;    // lenght of the window stored in wind_q15
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
@@ -27,6 +33,23 @@ static float wind[MAX_SIGNAL_LENGHT];
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+static uint32_t ISqrt(uint32_t x){
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while(bit > x){
+        bit >>= 2;
+    }
+    while(bit != 0){
+        if(x >= root + bit){
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
 
 /*==================[external functions definition]==========================*/
 bool FFTInit(void){
@@ -59,6 +82,45 @@ void FFTMagnitude(float * signal, float * fft, uint16_t signal_lenght){
     memcpy(fft, fft_complex, (signal_lenght / 2) * sizeof(float));
 }
 
+bool FFTInitQ15(void){
+    esp_err_t ret = dsps_fft2r_init_sc16(NULL, CONFIG_DSP_MAX_FFT_SIZE);
+    if (ret != ESP_OK){
+        return false;
+    }
+    return true;
+}
+
+void FFTMagnitudeQ15(const int16_t * signal, int16_t * fft, uint16_t signal_lenght){
+    // Generate Hann window (only when lenght changes)
+    if(wind_q15_lenght != signal_lenght){
+        dsps_wind_hann_f32(wind, signal_lenght);
+        for(uint16_t i = 0; i < signal_lenght; i++){
+            wind_q15[i] = (int16_t)(wind[i] * INT16_MAX);
+        }
+        wind_q15_lenght = signal_lenght;
+    }
+    // Clear fft array
+    memset(fft_complex_q15, 0, 2 * MAX_SIGNAL_LENGHT * sizeof(int16_t));
+    // Multiply input array with window and store as real part
+    dsps_mul_s16(signal, wind_q15, fft_complex_q15, signal_lenght, 1, 1, 2, 15);
+    // Calculate FFT (each stage is scaled by 1/2, so the result is X[k] / N)
+    dsps_fft2r_sc16(fft_complex_q15, signal_lenght);
+    // Bit reverse
+    dsps_bit_rev_sc16_ansi(fft_complex_q15, signal_lenght);
+    // Convert one complex vector to two complex vectors
+    dsps_cplx2reC_sc16(fft_complex_q15, signal_lenght);
+    // Calculate FFT magnitude (4 * |X[k]| / N, as in FFTMagnitude())
+    for (int j = 0; j < signal_lenght / 2; j++){
+        int32_t re = fft_complex_q15[j*2+0];
+        int32_t im = fft_complex_q15[j*2+1];
+        uint32_t mag = 4 * ISqrt((uint32_t)(re*re) + (uint32_t)(im*im));
+        if(j == 0){
+            mag = mag / 2;
+        }
+        fft[j] = (mag > INT16_MAX) ? INT16_MAX : mag;
+    }
+}
+
 void FFTFrequency(float sample_freq, uint16_t signal_lenght, float * f){
     float freq_step = sample_freq / (float)signal_lenght;
     for(uint16_t i=0; i<(signal_lenght/2); i++){
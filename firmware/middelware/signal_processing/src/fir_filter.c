@@ -0,0 +1,93 @@
+/**
+ * @file fir_filter.c
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ * @brief 
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+/*==================[inclusions]=============================================*/
+#include <math.h>
+#include <string.h>
+#include <stdbool.h>
+#include "fir_filter.h"
+#include "esp_dsp.h"
+/*==================[macros and definitions]=================================*/
+#define Q15_ONE     32767
+/*==================[internal data declaration]==============================*/
+fir_s16_t lp_fir, hp_fir;
+static int16_t lp_coeff[FIR_TAPS_MAX];
+static int16_t hp_coeff[FIR_TAPS_MAX];
+static int16_t lp_delay[FIR_TAPS_MAX];
+static int16_t hp_delay[FIR_TAPS_MAX];
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/**
+ * @brief Design a windowed sinc low pass (or its spectral inversion) and store it in Q15
+ * 
+ * @param coeff     Array to store coefficients
+ * @param f         Cut-off frequency normalized to sample frequency
+ * @param taps      Number of coefficients (odd)
+ * @param hi_pass   true: invert the low pass response
+ */
+static void FirDesign(int16_t * coeff, float f, uint8_t taps, bool hi_pass){
+    float h[FIR_TAPS_MAX];
+    float sum = 0;
+    int16_t m = taps / 2;
+    for(int16_t i = 0; i < taps; i++){
+        int16_t n = i - m;
+        h[i] = (n == 0) ? 2 * f : sinf(2 * M_PI * f * n) / (M_PI * n);
+        h[i] *= 0.54 - 0.46 * cosf(2 * M_PI * i / (taps - 1));
+        sum += h[i];
+    }
+    for(int16_t i = 0; i < taps; i++){
+        // unity gain at DC
+        h[i] /= sum;
+        if(hi_pass){
+            h[i] = (i == m) ? 1 - h[i] : -h[i];
+        }
+        float q = roundf(h[i] * Q15_ONE);
+        coeff[i] = (q > Q15_ONE) ? Q15_ONE : (q < -Q15_ONE) ? -Q15_ONE : (int16_t)q;
+    }
+}
+
+static uint8_t FirTaps(uint8_t taps){
+    if(taps > FIR_TAPS_MAX){
+        taps = FIR_TAPS_MAX;
+    }
+    // odd number of taps, so the hi pass has a center coefficient
+    return (taps < 3) ? 3 : (taps | 1);
+}
+
+/*==================[external functions definition]==========================*/
+void FirLowPassInit(float sample_frec, float cut_frec, uint8_t taps){
+    taps = FirTaps(taps);
+    FirDesign(lp_coeff, cut_frec / sample_frec, taps, false);
+    memset(lp_delay, 0, sizeof(lp_delay));
+    dsps_fird_init_s16(&lp_fir, lp_coeff, lp_delay, taps, 1, 0, 0);
+}
+
+void FirHiPassInit(float sample_frec, float cut_frec, uint8_t taps){
+    taps = FirTaps(taps);
+    FirDesign(hp_coeff, cut_frec / sample_frec, taps, true);
+    memset(hp_delay, 0, sizeof(hp_delay));
+    dsps_fird_init_s16(&hp_fir, hp_coeff, hp_delay, taps, 1, 0, 0);
+}
+
+void FirLowPassFilter(const int16_t * input_signal, int16_t * output_signal, int16_t signal_lenght){
+    dsps_fird_s16(&lp_fir, input_signal, output_signal, signal_lenght);
+}
+
+void FirHiPassFilter(const int16_t * input_signal, int16_t * output_signal, int16_t signal_lenght){
+    dsps_fird_s16(&hp_fir, input_signal, output_signal, signal_lenght);
+}
+
+/*==================[end of file]============================================*/
@@ -0,0 +1,89 @@
+/*! @mainpage Benchmark delay
+ *
+ * @section genDesc General Description
+ *
+ * This program measures the accuracy of the delay_mcu delay queue. For several delays, it
+ * reports how late DelayUs() returns (min/avg/max over BENCH_REPEAT calls). Then it runs
+ * BENCH_TASKS tasks delaying at the same time, to check that concurrent delays are honoured.
+ *
+ * Results are printed through the USB port (115200 baud).
+ *
+ * @section changelog Changelog
+ *
+ * |   Date	    | Description                                    |
+ * |:----------:|:-----------------------------------------------|
+ * | 17/10/2026 | Document creation		                         |
+ *
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "delay_mcu.h"
+#include "timer_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define BENCH_REPEAT	200		/*!< Delays measured for each length */
+#define BENCH_TASKS		4		/*!< Tasks delaying at the same time */
+/*==================[internal data definition]===============================*/
+static const uint16_t bench_delays[] = {60, 100, 200, 500, 1000, 5000};	/*!< Delays measured (in us) */
+TaskHandle_t main_task_handle = NULL;
+/*==================[internal functions declaration]=========================*/
+/**
+ * @brief Mide cuánto tarde retorna DelayUs(usec): mínimo, promedio y máximo en us
+ */
+static void BenchDelay(uint16_t usec, int32_t *min, int32_t *avg, int32_t *max){
+	int64_t acc = 0;
+	*min = INT32_MAX;
+	*max = INT32_MIN;
+	for(uint16_t i = 0; i < BENCH_REPEAT; i++){
+		uint64_t start = TimerGetUs();
+		DelayUs(usec);
+		int32_t late = (int32_t)(TimerGetUs() - start) - usec;
+		acc += late;
+		if(late < *min){
+			*min = late;
+		}
+		if(late > *max){
+			*max = late;
+		}
+	}
+	*avg = acc / BENCH_REPEAT;
+}
+
+/**
+ * @brief Tarea que mide su propio retardo mientras las demás también esperan
+ */
+static void BenchTask(void *pvParameter){
+	uint16_t usec = (uintptr_t)pvParameter;
+	int32_t min, avg, max;
+	BenchDelay(usec, &min, &avg, &max);
+	printf("task %5u us: late min %" PRId32 " avg %" PRId32 " max %" PRId32 " us\n", usec, min, avg, max);
+	xTaskNotifyGive(main_task_handle);
+	vTaskDelete(NULL);
+}
+/*==================[external functions definition]==========================*/
+void app_main(void){
+	int32_t min, avg, max;
+	main_task_handle = xTaskGetCurrentTaskHandle();
+	/* la primera llamada crea el timer de la cola de retardos */
+	DelayUs(100);
+	printf("DelayUs lateness, %u calls each\n", BENCH_REPEAT);
+	for(uint8_t i = 0; i < sizeof(bench_delays) / sizeof(bench_delays[0]); i++){
+		BenchDelay(bench_delays[i], &min, &avg, &max);
+		printf("%5u us: late min %" PRId32 " avg %" PRId32 " max %" PRId32 " us\n", bench_delays[i], min, avg, max);
+	}
+	printf("%u concurrent tasks\n", BENCH_TASKS);
+	for(uint8_t i = 0; i < BENCH_TASKS; i++){
+		xTaskCreate(&BenchTask, "BENCH", 2048, (void *)(uintptr_t)(100 + 150 * i), 5, NULL);
+	}
+	for(uint8_t i = 0; i < BENCH_TASKS; i++){
+		ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+	}
+	printf("done\n");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,85 @@
+/*! @mainpage Benchmark UART
+ *
+ * @section genDesc General Description
+ *
+ * This program measures the UART transmission path of uart_mcu on UART_CONNECTOR, with TX
+ * internally connected to RX, at 115200, 921600 and 2000000 baud:
+ * - CPU time of each UartSendBufferAsync() and UartSendBuffer() call (BENCH_CALL_SIZE bytes).
+ * - Sustained throughput, out-of-sequence bytes, FIFO overflows and CPU load reported by
+ * UartLoopbackBenchmark().
+ *
+ * Results are printed through the USB port (115200 baud). Nothing must be connected to J2.
+ *
+ * @section changelog Changelog
+ *
+ * |   Date	    | Description                                    |
+ * |:----------:|:-----------------------------------------------|
+ * | 17/10/2026 | Document creation		                         |
+ *
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "uart_mcu.h"
+#include "timer_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define BENCH_CALL_SIZE		64		/*!< Bytes sent on each measured call */
+#define BENCH_CALLS			16		/*!< Calls measured (all of them fit in the rings) */
+#define BENCH_DURATION		2000	/*!< Loopback benchmark duration (in ms) */
+#define BENCH_RING_SIZE		4096	/*!< Reception and transmission rings */
+/*==================[internal data definition]===============================*/
+static const uint32_t bench_bauds[] = {115200, 921600, 2000000};	/*!< Baud rates measured */
+static char bench_data[BENCH_CALL_SIZE];
+/*==================[internal functions declaration]=========================*/
+/**
+ * @brief Ciclos de CPU promedio de cada llamada a la función de envío
+ */
+static uint32_t BenchCall(bool async){
+	uint64_t cycles = 0;
+	UartTxWaitDone(UART_CONNECTOR, 1000);
+	for(uint8_t i = 0; i < BENCH_CALLS; i++){
+		uint32_t start = TimerGetCycles32();
+		if(async){
+			UartSendBufferAsync(UART_CONNECTOR, bench_data, BENCH_CALL_SIZE);
+		} else {
+			UartSendBuffer(UART_CONNECTOR, bench_data, BENCH_CALL_SIZE);
+		}
+		cycles += (uint32_t)(TimerGetCycles32() - start);
+	}
+	UartTxWaitDone(UART_CONNECTOR, 1000);
+	return cycles / BENCH_CALLS;
+}
+/*==================[external functions definition]==========================*/
+void app_main(void){
+	uart_bench_t result;
+	serial_config_t config = {
+		.port = UART_CONNECTOR,
+		.baud_rate = bench_bauds[0],
+		.func_p = UART_NO_INT,
+		.rx_buffer_size = BENCH_RING_SIZE,
+		.tx_buffer_size = BENCH_RING_SIZE,
+		.loopback = true,
+	};
+	UartInit(&config);
+	for(uint8_t i = 0; i < sizeof(bench_bauds) / sizeof(bench_bauds[0]); i++){
+		/* uart_mcu no permite reconfigurar el baudrate: se usa el driver de IDF */
+		uart_set_baudrate(UART_NUM_1, bench_bauds[i]);
+		uint32_t async_cycles = BenchCall(true);
+		uint32_t sync_cycles = BenchCall(false);
+		UartLoopbackBenchmark(UART_CONNECTOR, BENCH_DURATION, &result);
+		printf("%7" PRIu32 " baud: call %u bytes async %" PRIu32 " cycles, blocking %" PRIu32 " cycles\n",
+			bench_bauds[i], BENCH_CALL_SIZE, async_cycles, sync_cycles);
+		printf("%7" PRIu32 " baud: %" PRIu32 " bytes/s (%" PRIu32 "%% of line rate), %" PRIu32 " errors, %" PRIu32 " FIFO overflows, CPU %u%%\n",
+			bench_bauds[i], result.bytes_per_s, result.bytes_per_s * 10 * 100 / bench_bauds[i],
+			result.errors, result.fifo_ovf, result.cpu_load);
+	}
+	printf("done\n");
+}
+/*==================[end of file]============================================*/
@@ -0,0 +1,179 @@
+/*! @mainpage Benchmark UART line mode
+ *
+ * @section genDesc General Description
+ *
+ * This program compares the reception of text commands in UART_CONNECTOR (TX internally
+ * connected to RX) through the line mode of uart_mcu (UartLineInit(), hardware pattern
+ * detection and command table) and through the per-byte path (UartInit() callback reading
+ * with UartReadByte()). Select the path with BENCH_LINE_MODE.
+ *
+ * "ping <sequence> <timestamp>" lines are sent at 115200 and 921600 baud:
+ * - Latency: one line at a time, time from the call to UartSendBuffer() to the command
+ * callback (min/avg/max over BENCH_LINES lines). The time the line takes on the wire is
+ * printed as a reference.
+ * - Throughput: BENCH_LINES lines back to back, lines/s received and lines lost.
+ *
+ * Results are printed through the USB port (115200 baud). Nothing must be connected to J2.
+ *
+ * @section changelog Changelog
+ *
+ * |   Date	    | Description                                    |
+ * |:----------:|:-----------------------------------------------|
+ * | 17/10/2026 | Document creation		                         |
+ * | 17/10/2026 | Same rings and loopback in both paths          |
+ *
+ * @author Albano Peñalva (albano.penalva@uner.edu.ar)
+ *
+ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "uart_mcu.h"
+#include "timer_mcu.h"
+/*==================[macros and definitions]=================================*/
+#define BENCH_LINE_MODE		1		/*!< 1: UartLineInit(), 0: UartInit() callback with UartReadByte() */
+#define BENCH_LINES			500		/*!< Lines sent in each measurement */
+#define BENCH_TIMEOUT		3000	/*!< Maximum wait for the lines (in ms) */
+#define BENCH_RING_SIZE		4096	/*!< Reception and transmission rings */
+#define BENCH_LINE_SIZE		48		/*!< Line buffer of the per-byte path */
+/*==================[internal data definition]===============================*/
+static const uint32_t bench_bauds[] = {115200, 921600};	/*!< Baud rates measured */
+TaskHandle_t main_task_handle = NULL;
+static volatile uint32_t lines_received = 0;	/*!< ping lines received */
+static volatile uint32_t lines_lost = 0;		/*!< Gaps in the sequence numbers */
+static volatile uint32_t next_sequence = 0;		/*!< Expected sequence number */
+static volatile uint32_t lines_expected = 0;	/*!< Lines after which the main task is notified */
+static int64_t latency_acc;
+static uint32_t latency_min, latency_max;
+/*==================[internal functions declaration]=========================*/
+/**
+ * @brief Comando "ping <secuencia> <timestamp>": cuenta la línea y acumula la latencia
+ */
+static void PingCommand(char *args, void *param){
+	uint64_t now = TimerGetUs();
+	char *end;
+	uint32_t sequence = strtoul(args, &end, 10);
+	uint32_t latency = now - strtoull(end, NULL, 10);
+	if(sequence != next_sequence){
+		lines_lost += sequence - next_sequence;
+	}
+	next_sequence = sequence + 1;
+	latency_acc += latency;
+	if(latency < latency_min){
+		latency_min = latency;
+	}
+	if(latency > latency_max){
+		latency_max = latency;
+	}
+	if(++lines_received == lines_expected){
+		xTaskNotifyGive(main_task_handle);
+	}
+}
+
+#if !BENCH_LINE_MODE
+/**
+ * @brief Camino anterior: arma la línea byte a byte con UartReadByte() en el callback de recepción
+ */
+static void ByteCallback(void *param){
+	static char line[BENCH_LINE_SIZE];
+	static uint8_t length = 0;
+	uint8_t byte;
+	while(UartReadByte(UART_CONNECTOR, &byte)){
+		if(byte == '\n'){
+			line[length] = '\0';
+			if(strncmp(line, "ping ", 5) == 0){
+				PingCommand(&line[5], NULL);
+			}
+			length = 0;
+		} else if(length < BENCH_LINE_SIZE - 1){
+			line[length++] = byte;
+		}
+	}
+}
+#endif
+
+/**
+ * @brief Envía una línea "ping" con la secuencia y el instante de envío
+ */
+static void SendPing(uint32_t sequence){
+	char line[BENCH_LINE_SIZE];
+	uint8_t length = snprintf(line, sizeof(line), "ping %" PRIu32 " %" PRIu64 "\n", sequence, TimerGetUs());
+	UartSendBuffer(UART_CONNECTOR, line, length);
+}
+
+static void BenchReset(uint32_t expected){
+	lines_received = 0;
+	lines_lost = 0;
+	next_sequence = 0;
+	latency_acc = 0;
+	latency_min = UINT32_MAX;
+	latency_max = 0;
+	lines_expected = expected;
+}
+/*==================[external functions definition]==========================*/
+void app_main(void){
+	main_task_handle = xTaskGetCurrentTaskHandle();
+#if BENCH_LINE_MODE
+	static const uart_command_t commands[] = {
+		{.name = "ping", .func_p = PingCommand},
+	};
+	uart_line_config_t line_config = {
+		.port = UART_CONNECTOR,
+		.baud_rate = bench_bauds[0],
+		.delimiter = '\n',
+		.commands = commands,
+		.command_qty = sizeof(commands) / sizeof(commands[0]),
+		.rx_buffer_size = BENCH_RING_SIZE,
+		.tx_buffer_size = BENCH_RING_SIZE,
+		.loopback = true,
+	};
+	UartLineInit(&line_config);
+	printf("Line mode (UartLineInit)\n");
+#else
+	serial_config_t config = {
+		.port = UART_CONNECTOR,
+		.baud_rate = bench_bauds[0],
+		.func_p = ByteCallback,
+		.rx_buffer_size = BENCH_RING_SIZE,
+		.tx_buffer_size = BENCH_RING_SIZE,
+		.loopback = true,
+	};
+	UartInit(&config);
+	printf("Per-byte path (UartInit + UartReadByte)\n");
+#endif
+	for(uint8_t i = 0; i < sizeof(bench_bauds) / sizeof(bench_bauds[0]); i++){
+		/* uart_mcu no permite reconfigurar el baudrate: se usa el driver de IDF */
+		uart_set_baudrate(UART_NUM_1, bench_bauds[i]);
+		vTaskDelay(pdMS_TO_TICKS(10));
+		/* latencia: una línea por vez */
+		BenchReset(1);
+		for(uint32_t n = 0; n < BENCH_LINES; n++){
+			lines_received = 0;
+			SendPing(n);
+			ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BENCH_TIMEOUT));
+		}
+		uint32_t latency_avg = latency_acc / (next_sequence ? next_sequence - lines_lost : 1);
+		printf("%6" PRIu32 " baud: latency min %" PRIu32 " avg %" PRIu32 " max %" PRIu32 " us (20 bytes on the wire: %" PRIu32 " us), %" PRIu32 " lost\n",
+			bench_bauds[i], latency_min, latency_avg, latency_max, 20 * 10 * 1000000 / bench_bauds[i], (uint32_t)lines_lost);
+		/* throughput: líneas seguidas */
+		BenchReset(BENCH_LINES);
+		uint64_t start = TimerGetUs();
+		for(uint32_t n = 0; n < BENCH_LINES; n++){
+			SendPing(n);
+		}
+		bool done = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BENCH_TIMEOUT));
+		uint32_t elapsed = TimerGetUs() - start;
+		printf("%6" PRIu32 " baud: %" PRIu32 " of %u lines in %" PRIu32 " us (%" PRIu32 " lines/s)%s\n",
+			bench_bauds[i], (uint32_t)lines_received, BENCH_LINES, elapsed,
+			(uint32_t)((uint64_t)lines_received * 1000000 / elapsed), done ? "" : ", timeout");
+	}
+	printf("done\n");
+}
+/*==================[end of file]============================================*/